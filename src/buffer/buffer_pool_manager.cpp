@@ -0,0 +1,87 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_manager.cpp
+//
+// Identification: src/buffer/buffer_pool_manager.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_manager.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+#include "common/logger.h"
+
+namespace bustub {
+
+namespace {
+
+/** Identifies a residency file: "BTRS" followed by the format version. */
+constexpr uint32_t RESIDENCY_FILE_MAGIC = 0x42545253;
+constexpr uint32_t RESIDENCY_FILE_VERSION = 1;
+
+}  // namespace
+
+auto BufferPoolManager::SaveResidency(const std::string &file_name) -> bool {
+  std::vector<page_id_t> page_ids = GetResidentPages();
+  const std::string tmp_file_name = file_name + ".tmp";
+  {
+    std::ofstream out(tmp_file_name, std::ios::binary | std::ios::trunc | std::ios::out);
+    const auto num_pages = static_cast<uint32_t>(page_ids.size());
+    out.write(reinterpret_cast<const char *>(&RESIDENCY_FILE_MAGIC), sizeof(RESIDENCY_FILE_MAGIC));
+    out.write(reinterpret_cast<const char *>(&RESIDENCY_FILE_VERSION), sizeof(RESIDENCY_FILE_VERSION));
+    out.write(reinterpret_cast<const char *>(&num_pages), sizeof(num_pages));
+    out.write(reinterpret_cast<const char *>(page_ids.data()),
+              static_cast<std::streamsize>(page_ids.size() * sizeof(page_id_t)));
+    out.flush();
+    if (!out) {
+      LOG_DEBUG("I/O error while writing residency file %s", tmp_file_name.c_str());
+      std::remove(tmp_file_name.c_str());
+      return false;
+    }
+  }
+  // A crash while saving leaves the previous residency file intact.
+  if (std::rename(tmp_file_name.c_str(), file_name.c_str()) != 0) {
+    LOG_DEBUG("cannot replace residency file %s", file_name.c_str());
+    std::remove(tmp_file_name.c_str());
+    return false;
+  }
+  return true;
+}
+
+auto BufferPoolManager::LoadResidency(const std::string &file_name) -> size_t {
+  std::ifstream in(file_name, std::ios::binary | std::ios::in);
+  if (!in.is_open()) {
+    return 0;
+  }
+  uint32_t magic = 0;
+  uint32_t version = 0;
+  uint32_t num_pages = 0;
+  in.read(reinterpret_cast<char *>(&magic), sizeof(magic));
+  in.read(reinterpret_cast<char *>(&version), sizeof(version));
+  in.read(reinterpret_cast<char *>(&num_pages), sizeof(num_pages));
+  if (!in || magic != RESIDENCY_FILE_MAGIC || version != RESIDENCY_FILE_VERSION) {
+    LOG_DEBUG("ignoring invalid residency file %s", file_name.c_str());
+    return 0;
+  }
+
+  // The file lists the hottest pages first; only as many as fit in the pool are worth reading.
+  std::vector<page_id_t> page_ids(std::min<size_t>(num_pages, GetPoolSize()));
+  in.read(reinterpret_cast<char *>(page_ids.data()), static_cast<std::streamsize>(page_ids.size() * sizeof(page_id_t)));
+  if (!in) {
+    LOG_DEBUG("ignoring truncated residency file %s", file_name.c_str());
+    return 0;
+  }
+  page_ids.erase(std::remove(page_ids.begin(), page_ids.end(), INVALID_PAGE_ID), page_ids.end());
+  std::sort(page_ids.begin(), page_ids.end());
+  PrefetchPages(page_ids);
+  return page_ids.size();
+}
+
+}  // namespace bustub
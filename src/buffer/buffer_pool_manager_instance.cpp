@@ -12,62 +12,669 @@
 
 #include "buffer/buffer_pool_manager_instance.h"
 
+#include <sys/mman.h>
+#include <algorithm>
+#include <new>
+
+#include "common/exception.h"
 #include "common/macros.h"
 
 namespace bustub {
 
+namespace {
+
+constexpr size_t HUGE_PAGE_SIZE = 2 << 20;
+
+/** Maps a page-aligned arena of at least the given size, rounding the size up to what was actually mapped. */
+auto MapFrameArena(size_t *size) -> char * {
+  void *arena = MAP_FAILED;
+  if (*size >= HUGE_PAGE_SIZE) {
+    // Explicit huge pages only exist if the administrator reserved them.
+    size_t huge_size = (*size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    arena = mmap(nullptr, huge_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (arena != MAP_FAILED) {
+      *size = huge_size;
+      return static_cast<char *>(arena);
+    }
+  }
+  *size = std::max<size_t>(*size, PAGE_SIZE);
+  arena = mmap(nullptr, *size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (arena == MAP_FAILED) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "can't map the buffer pool frames");
+  }
+  if (*size >= HUGE_PAGE_SIZE) {
+    // Otherwise ask for transparent huge pages; this is only a hint.
+    madvise(arena, *size, MADV_HUGEPAGE);
+  }
+  return static_cast<char *>(arena);
+}
+
+}  // namespace
+
 BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager,
-                                                     LogManager *log_manager)
-    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, log_manager) {}
+                                                     LogManager *log_manager, ReplacerType replacer_type)
+    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, log_manager, replacer_type) {}
 
 BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
-                                                     DiskManager *disk_manager, LogManager *log_manager)
+                                                     DiskManager *disk_manager, LogManager *log_manager,
+                                                     ReplacerType replacer_type)
     : pool_size_(pool_size),
+      frame_segment_size_(std::max<size_t>(1, pool_size * num_instances)),
       num_instances_(num_instances),
       instance_index_(instance_index),
       next_page_id_(instance_index),
       disk_manager_(disk_manager),
-      log_manager_(log_manager) {
+      log_manager_(log_manager),
+      page_table_(NUM_PAGE_TABLE_SHARDS) {
   BUSTUB_ASSERT(num_instances > 0, "If BPI is not part of a pool, then the pool size should just be 1");
   BUSTUB_ASSERT(
       instance_index < num_instances,
       "BPI index cannot be greater than the number of BPIs in the pool. In non-parallel case, index should just be 1.");
   // We allocate a consecutive memory space for the buffer pool.
-  pages_ = new Page[pool_size_];
-  replacer_ = new LRUReplacer(pool_size);
+  num_arena_frames_ = pool_size_;
+  frame_arena_size_ = num_arena_frames_ * PAGE_SIZE;
+  frame_arena_ = MapFrameArena(&frame_arena_size_);
+  pages_ = static_cast<Page *>(::operator new[](num_arena_frames_ * sizeof(Page)));
+  for (size_t i = 0; i < num_arena_frames_; ++i) {
+    new (&pages_[i]) Page(frame_arena_ + i * PAGE_SIZE);
+  }
+  switch (replacer_type) {
+    case ReplacerType::LRU_K:
+      replacer_ = new LRUKReplacer(frame_segment_size_);
+      break;
+    case ReplacerType::CLOCK:
+      replacer_ = new ClockReplacer(frame_segment_size_);
+      break;
+    case ReplacerType::LRU:
+    default:
+      replacer_ = new LRUReplacer(frame_segment_size_);
+      break;
+  }
 
-  // Initially, every page is in the free list.
+  // Initially, every page is in the free list. The first segment of frame ids has room for every frame of a parallel
+  // BPM; the ids beyond the pool size are left empty for frames adopted from sibling instances.
+  AddFrameSegment();
   for (size_t i = 0; i < pool_size_; ++i) {
+    empty_frame_ids_.pop_back();
+    GetFrame(i) = &pages_[i];
     free_list_.emplace_back(static_cast<int>(i));
   }
 }
 
 BufferPoolManagerInstance::~BufferPoolManagerInstance() {
-  delete[] pages_;
+  StopBackgroundWriter();
+  StopPrefetchThread();
+  for (size_t i = 0; i < num_arena_frames_; ++i) {
+    pages_[i].~Page();
+  }
+  ::operator delete[](pages_);
+  munmap(frame_arena_, frame_arena_size_);
+  for (Page *page : allocated_pages_) {
+    delete page;
+  }
+  for (auto *segment : frame_segments_) {
+    delete[] segment;
+  }
   delete replacer_;
+  delete compressed_cache_;
 }
 
-auto BufferPoolManagerInstance::FlushPgImp(page_id_t page_id) -> bool {
-  // Make sure you call DiskManager::WritePage!
+template <typename Lock>
+auto BufferPoolManagerInstance::PinFrame(PageTableShard *shard, Lock *lock, frame_id_t frame_id) -> Page * {
+  Page *p_page = PinResidentFrame(frame_id);
+  const page_id_t page_id = p_page->page_id_;
+  // A concurrent miss may still be reading the page in.
+  shard->loaded_cv_.wait(*lock, [p_page] { return !p_page->is_loading_; });
+  if (p_page->page_id_ != page_id) {
+    UnpinFailedFrame(frame_id);
+    return nullptr;
+  }
+  return p_page;
+}
+
+auto BufferPoolManagerInstance::PinResidentFrame(frame_id_t frame_id) -> Page * {
+  Page *p_page = GetFrame(frame_id);
+  if (p_page->pin_count_.fetch_add(1) == 0) {
+    replacer_->Pin(frame_id);
+  }
+  replacer_->RecordAccess(frame_id);
+  return p_page;
+}
+
+template <typename Lock>
+void BufferPoolManagerInstance::LockTimed(Lock *lock) {
+  if (lock->try_lock()) {
+    return;
+  }
+  auto start = std::chrono::steady_clock::now();
+  lock->lock();
+  auto wait = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+  num_latch_waits_.Add();
+  latch_wait_ns_.Add(wait.count());
+}
+
+auto BufferPoolManagerInstance::AcquireFrame(frame_id_t *frame_id, BufferAccessStrategy *strategy) -> bool {
+  // Victims and ring entries may name frames that a concurrent shrink is about to free.
+  auto resize_lock = std::shared_lock(resize_latch_);
+  if (strategy != nullptr && RecycleRingFrame(strategy, frame_id)) {
+    return true;
+  }
+  {
+    auto lock = std::unique_lock(latch_, std::defer_lock);
+    LockTimed(&lock);
+    if (!free_list_.empty()) {
+      *frame_id = free_list_.front();
+      free_list_.pop_front();
+      return true;
+    }
+  }
+  frame_id_t victim;
+  while (replacer_->Victim(&victim)) {
+    if (EvictFrame(victim)) {
+      // Only now is the frame's history stale; a victim that was pinned again keeps it.
+      replacer_->Remove(victim);
+      *frame_id = victim;
+      return true;
+    }
+  }
+  return false;
+}
+
+auto BufferPoolManagerInstance::RecycleRingFrame(BufferAccessStrategy *strategy, frame_id_t *frame_id) -> bool {
+  auto &ring = strategy->rings_[this];
+  // The ring is split evenly between the instances of a parallel buffer pool.
+  const size_t ring_size = std::max<size_t>(1, strategy->ring_size_ / num_instances_);
+  while (ring.size() >= ring_size) {
+    auto [candidate, page_id] = ring.front();
+    ring.pop_front();
+    if (EvictFrame(candidate, page_id)) {
+      // The frame is still in the replacer from when the scan unpinned it.
+      replacer_->Remove(candidate);
+      *frame_id = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+auto BufferPoolManagerInstance::EvictFrame(frame_id_t frame_id, page_id_t expected_page_id) -> bool {
+  Page *p_page = GetFrame(frame_id);
+  if (p_page == nullptr) {
+    return false;
+  }
+  page_id_t page_id = p_page->page_id_;
+  if (page_id == INVALID_PAGE_ID || (expected_page_id != INVALID_PAGE_ID && page_id != expected_page_id)) {
+    return false;
+  }
+  auto &shard = GetShard(page_id);
+  auto lock = std::unique_lock(shard.latch_, std::defer_lock);
+  LockTimed(&lock);
+  auto iter = shard.page_table_.find(page_id);
+  // The frame was pinned, deleted or remapped after the replacer picked it.
+  if (iter == shard.page_table_.end() || iter->second != frame_id || p_page->pin_count_ > 0) {
+    return false;
+  }
+  IOCategoryScope io_category(IOCategory::EVICTION);
+  if (compressed_cache_ != nullptr) {
+    // The page is inserted before it leaves the page table, so a miss that no longer finds it there will find it in
+    // the compressed page cache. A dirty page is only written back once the compressed page cache evicts it.
+    compressed_cache_->Insert(page_id, p_page->GetData(), p_page->is_dirty_);
+    p_page->is_dirty_ = false;
+  } else if (p_page->is_dirty_) {
+    disk_manager_->WritePage(page_id, p_page->GetData());
+    p_page->is_dirty_ = false;
+    num_foreground_writebacks_.Add();
+  }
+  shard.page_table_.erase(iter);
+  p_page->page_id_ = INVALID_PAGE_ID;
+  num_evictions_.Add();
+  return true;
+}
+
+void BufferPoolManagerInstance::ReleaseFrame(frame_id_t frame_id) {
+  auto lock = std::unique_lock(latch_, std::defer_lock);
+  LockTimed(&lock);
+  free_list_.emplace_back(frame_id);
+}
+
+void BufferPoolManagerInstance::EnableCompressedCache(size_t capacity) {
+  BUSTUB_ASSERT(compressed_cache_ == nullptr, "The compressed page cache is already enabled");
+  compressed_cache_ = new CompressedPageCache(capacity, disk_manager_);
+}
+
+auto BufferPoolManagerInstance::TakeFromCompressedCache(page_id_t page_id, Page *p_page) -> bool {
+  bool is_dirty = false;
+  if (compressed_cache_ == nullptr || !compressed_cache_->Take(page_id, p_page->GetData(), &is_dirty)) {
+    return false;
+  }
+  if (is_dirty) {
+    p_page->is_dirty_ = true;
+  }
+  return true;
+}
+
+auto BufferPoolManagerInstance::ReadPageIn(page_id_t page_id, Page *p_page) -> bool {
+  if (TakeFromCompressedCache(page_id, p_page)) {
+    return true;
+  }
+  IOCategoryScope io_category(IOCategory::BUFFER_MISS);
+  return disk_manager_->ReadPage(page_id, p_page->GetData());
+}
+
+void BufferPoolManagerInstance::FinishLoading(frame_id_t frame_id, page_id_t page_id, bool loaded) {
+  Page *p_page = GetFrame(frame_id);
+  auto &shard = GetShard(page_id);
+  {
+    auto lock = std::lock_guard(shard.latch_);
+    p_page->is_loading_ = false;
+    if (!loaded) {
+      // Serving the frame's content would hand out a corrupted or stale page.
+      shard.page_table_.erase(page_id);
+      p_page->page_id_ = INVALID_PAGE_ID;
+      p_page->is_dirty_ = false;
+      UnpinFailedFrame(frame_id);
+    }
+  }
+  shard.loaded_cv_.notify_all();
+}
+
+void BufferPoolManagerInstance::UnpinFailedFrame(frame_id_t frame_id) {
+  Page *p_page = GetFrame(frame_id);
+  if (p_page->pin_count_.fetch_sub(1) == 1) {
+    replacer_->Remove(frame_id);
+    ReleaseFrame(frame_id);
+  }
+}
+
+auto BufferPoolManagerInstance::GetStats() -> BufferPoolStats {
+  BufferPoolStats stats;
+  stats.num_hits_ = num_hits_.Load();
+  stats.num_misses_ = num_misses_.Load();
+  stats.num_new_pages_ = num_new_pages_.Load();
+  stats.num_prefetches_ = num_prefetches_.Load();
+  stats.num_evictions_ = num_evictions_.Load();
+  stats.num_foreground_writebacks_ = num_foreground_writebacks_.Load();
+  stats.num_background_writebacks_ = num_background_writebacks_.Load();
+  stats.num_flushes_ = num_flushes_.Load();
+  stats.num_latch_waits_ = num_latch_waits_.Load();
+  stats.latch_wait_ns_ = latch_wait_ns_.Load();
+  if (compressed_cache_ != nullptr) {
+    stats.num_compressed_hits_ = compressed_cache_->GetNumHits();
+    stats.num_compressed_misses_ = compressed_cache_->GetNumMisses();
+    stats.compressed_bytes_ = compressed_cache_->GetSize();
+    stats.num_compressed_pages_ = compressed_cache_->GetNumPages();
+  }
+
+  // The gauges are read without the shard latches, so under concurrent use they are only approximately consistent.
+  auto resize_lock = std::shared_lock(resize_latch_);
+  stats.pool_size_ = pool_size_;
+  {
+    auto lock = std::lock_guard(latch_);
+    stats.num_free_frames_ = free_list_.size();
+  }
+  for (size_t i = 0; i < num_frame_ids_; i++) {
+    Page *p_page = GetFrame(i);
+    if (p_page == nullptr || p_page->GetPageId() == INVALID_PAGE_ID) {
+      continue;
+    }
+    if (p_page->IsDirty()) {
+      stats.num_dirty_frames_++;
+    }
+    stats.pin_count_histogram_[BufferPoolStats::PinCountBucket(p_page->GetPinCount())]++;
+  }
+  return stats;
+}
+
+void BufferPoolManagerInstance::ResetStats() {
+  num_hits_.Reset();
+  num_misses_.Reset();
+  num_new_pages_.Reset();
+  num_prefetches_.Reset();
+  num_evictions_.Reset();
+  num_foreground_writebacks_.Reset();
+  num_background_writebacks_.Reset();
+  num_flushes_.Reset();
+  num_latch_waits_.Reset();
+  latch_wait_ns_.Reset();
+  if (compressed_cache_ != nullptr) {
+    compressed_cache_->ResetStats();
+  }
+}
+
+auto BufferPoolManagerInstance::DonateFrame() -> Page * {
   frame_id_t frame_id = -1;
-  Page *p_page = nullptr;
+  if (!AcquireFrame(&frame_id)) {
+    return nullptr;
+  }
+  Page *p_page = GetFrame(frame_id);
+  p_page->ResetMemory();
   auto lock = std::lock_guard(latch_);
-  auto iter = page_table_.find(page_id);
-  if (iter == page_table_.end()) {
+  GetFrame(frame_id) = nullptr;
+  empty_frame_ids_.emplace_back(frame_id);
+  pool_size_--;
+  return p_page;
+}
+
+void BufferPoolManagerInstance::AdoptFrame(Page *page) {
+  auto lock = std::lock_guard(latch_);
+  if (empty_frame_ids_.empty()) {
+    AddFrameSegment();
+  }
+  frame_id_t frame_id = empty_frame_ids_.back();
+  empty_frame_ids_.pop_back();
+  GetFrame(frame_id) = page;
+  free_list_.emplace_back(frame_id);
+  pool_size_++;
+}
+
+void BufferPoolManagerInstance::AddFrameSegment() {
+  size_t segment = 0;
+  while (frame_segments_[segment] != nullptr) {
+    segment++;
+  }
+  BUSTUB_ASSERT(segment < NUM_FRAME_SEGMENTS, "Too many frames in the buffer pool");
+  const size_t segment_size = frame_segment_size_ << segment;
+  frame_segments_[segment] = new std::atomic<Page *>[segment_size];
+  const size_t first_frame_id = num_frame_ids_;
+  for (size_t i = segment_size; i > 0; i--) {
+    frame_segments_[segment][i - 1] = nullptr;
+    empty_frame_ids_.emplace_back(static_cast<frame_id_t>(first_frame_id + i - 1));
+  }
+  num_frame_ids_ += segment_size;
+  replacer_->SetCapacity(num_frame_ids_);
+}
+
+auto BufferPoolManagerInstance::GetResidentPages() -> std::vector<page_id_t> {
+  auto resize_lock = std::shared_lock(resize_latch_);
+  std::vector<page_id_t> page_ids;
+  // Pinned pages are in use right now, so they count as the most recently used.
+  for (size_t i = 0; i < num_frame_ids_; i++) {
+    Page *p_page = GetFrame(i);
+    if (p_page != nullptr && p_page->GetPageId() != INVALID_PAGE_ID && p_page->GetPinCount() > 0) {
+      page_ids.push_back(p_page->GetPageId());
+    }
+  }
+  std::vector<frame_id_t> eviction_order = replacer_->GetEvictionOrder();
+  for (auto iter = eviction_order.rbegin(); iter != eviction_order.rend(); ++iter) {
+    Page *p_page = GetFrame(*iter);
+    if (p_page != nullptr && p_page->GetPageId() != INVALID_PAGE_ID && p_page->GetPinCount() == 0) {
+      page_ids.push_back(p_page->GetPageId());
+    }
+  }
+  return page_ids;
+}
+
+auto BufferPoolManagerInstance::ResizeImp(size_t pool_size) -> bool {
+  auto lock = std::lock_guard(resize_mutex_);
+  // Grow with the frames retired by earlier shrinks first, then with new frames.
+  while (pool_size_ < pool_size) {
+    Page *page;
+    if (!retired_pages_.empty()) {
+      page = retired_pages_.back();
+      retired_pages_.pop_back();
+    } else {
+      page = new Page();
+      allocated_pages_.insert(page);
+    }
+    AdoptFrame(page);
+  }
+  if (pool_size_ <= pool_size) {
+    return true;
+  }
+
+  // Shrink: free frames go first, then frames holding clean pages, then frames holding dirty pages, which are
+  // written back. Pinned pages stay, so the pool may end up larger than requested.
+  const size_t num_frames = pool_size_ - pool_size;
+  std::vector<frame_id_t> claimed;
+  {
+    auto free_lock = std::lock_guard(latch_);
+    while (claimed.size() < num_frames && !free_list_.empty()) {
+      claimed.push_back(free_list_.front());
+      free_list_.pop_front();
+    }
+  }
+  for (bool clean_only : {true, false}) {
+    auto resize_lock = std::shared_lock(resize_latch_);
+    for (size_t i = 0; i < num_frame_ids_ && claimed.size() < num_frames; i++) {
+      Page *p_page = GetFrame(i);
+      if (p_page == nullptr || p_page->page_id_ == INVALID_PAGE_ID || p_page->pin_count_ > 0 ||
+          (clean_only && p_page->is_dirty_)) {
+        continue;
+      }
+      if (EvictFrame(i)) {
+        // The frame was evicted without going through Victim, so it is still in the replacer.
+        replacer_->Remove(i);
+        claimed.push_back(i);
+      }
+    }
+  }
+
+  // Nobody else can be using the claimed frames, but scans may still be looking at them.
+  auto resize_lock = std::unique_lock(resize_latch_);
+  auto free_lock = std::lock_guard(latch_);
+  for (frame_id_t frame_id : claimed) {
+    Page *page = GetFrame(frame_id);
+    GetFrame(frame_id) = nullptr;
+    empty_frame_ids_.push_back(frame_id);
+    pool_size_--;
+    if (allocated_pages_.erase(page) > 0) {
+      delete page;
+    } else {
+      // Part of an array allocated at construction, possibly by a sibling, so it can only be reused.
+      page->ResetMemory();
+      retired_pages_.push_back(page);
+    }
+  }
+  return pool_size_ <= pool_size;
+}
+
+void BufferPoolManagerInstance::StopPrefetchThread() {
+  std::thread *prefetch_thread;
+  {
+    auto lock = std::lock_guard(prefetch_latch_);
+    prefetch_thread = prefetch_thread_;
+    prefetch_thread_ = nullptr;
+    prefetch_running_ = false;
+  }
+  if (prefetch_thread != nullptr) {
+    prefetch_cv_.notify_all();
+    prefetch_thread->join();
+    delete prefetch_thread;
+  }
+}
+
+void BufferPoolManagerInstance::RunBackgroundWriter(size_t low_watermark, size_t max_pages_per_round,
+                                                    std::chrono::milliseconds interval) {
+  auto lock = std::lock_guard(background_writer_latch_);
+  if (background_writer_ != nullptr) {
+    return;
+  }
+  background_writer_running_ = true;
+  background_writer_ = new std::thread([this, low_watermark, max_pages_per_round, interval] {
+    auto lock = std::unique_lock(background_writer_latch_);
+    while (!background_writer_cv_.wait_for(lock, interval, [this] { return !background_writer_running_; })) {
+      lock.unlock();
+      BackgroundWriterRound(low_watermark, max_pages_per_round);
+      lock.lock();
+    }
+  });
+}
+
+void BufferPoolManagerInstance::StopBackgroundWriter() {
+  std::thread *background_writer;
+  {
+    auto lock = std::lock_guard(background_writer_latch_);
+    background_writer = background_writer_;
+    background_writer_ = nullptr;
+    background_writer_running_ = false;
+  }
+  if (background_writer != nullptr) {
+    background_writer_cv_.notify_all();
+    background_writer->join();
+    delete background_writer;
+  }
+}
+
+void BufferPoolManagerInstance::BackgroundWriterRound(size_t low_watermark, size_t max_pages_per_round) {
+  size_t num_clean;
+  {
+    auto resize_lock = std::shared_lock(resize_latch_);
+    auto lock = std::lock_guard(latch_);
+    num_clean = free_list_.size();
+    for (size_t i = 0; i < num_frame_ids_; i++) {
+      Page *p_page = GetFrame(i);
+      if (p_page != nullptr && p_page->GetPageId() != INVALID_PAGE_ID && p_page->GetPinCount() == 0 &&
+          !p_page->IsDirty()) {
+        num_clean++;
+      }
+    }
+  }
+
+  size_t num_written = 0;
+  for (size_t i = 0; i < num_frame_ids_ && num_clean < low_watermark && num_written < max_pages_per_round; i++) {
+    frame_id_t frame_id = static_cast<frame_id_t>(background_writer_cursor_);
+    background_writer_cursor_ = (background_writer_cursor_ + 1) % num_frame_ids_;
+    if (CleanFrame(frame_id)) {
+      num_clean++;
+      num_written++;
+    }
+  }
+}
+
+auto BufferPoolManagerInstance::CleanFrame(frame_id_t frame_id) -> bool {
+  Page *p_page;
+  page_id_t page_id;
+  {
+    // Once pinned, the frame cannot be claimed by a shrink, so the resize latch is not held while writing.
+    auto resize_lock = std::shared_lock(resize_latch_);
+    p_page = GetFrame(frame_id);
+    if (p_page == nullptr) {
+      return false;
+    }
+    page_id = p_page->page_id_;
+    if (page_id == INVALID_PAGE_ID || p_page->pin_count_ > 0 || !p_page->is_dirty_) {
+      return false;
+    }
+    auto &shard = GetShard(page_id);
+    auto lock = std::shared_lock(shard.latch_);
+    auto iter = shard.page_table_.find(page_id);
+    if (iter == shard.page_table_.end() || iter->second != frame_id || p_page->is_loading_) {
+      return false;
+    }
+    // Pin the page so it cannot be evicted while it is written, without telling the replacer: the frame keeps its
+    // place in the eviction order. A victim picked meanwhile fails validation and is re-added when unpinned.
+    p_page->pin_count_++;
+  }
+  auto &shard = GetShard(page_id);
+
+  p_page->RLatch();
+  // Write-ahead logging: the page may only reach the disk after the log records that modified it.
+  bool is_durable = !enable_logging || log_manager_ == nullptr || p_page->GetLSN() <= log_manager_->GetPersistentLSN();
+  bool is_dirty = is_durable && p_page->is_dirty_.exchange(false);
+  if (is_dirty) {
+    IOCategoryScope io_category(IOCategory::EVICTION);
+    disk_manager_->WritePage(page_id, p_page->GetData());
+    num_background_writebacks_.Add();
+  }
+  p_page->RUnlatch();
+
+  auto lock = std::shared_lock(shard.latch_);
+  if (p_page->pin_count_.fetch_sub(1) == 1) {
+    replacer_->Unpin(frame_id);
+  }
+  return is_dirty;
+}
+
+auto BufferPoolManagerInstance::FlushPgImp(page_id_t page_id) -> bool {
+  // Make sure you call DiskManager::WritePage!
+  auto &shard = GetShard(page_id);
+  auto lock = std::shared_lock(shard.latch_);
+  auto iter = shard.page_table_.find(page_id);
+  if (iter == shard.page_table_.end()) {
+    // A page evicted into the compressed page cache may hold the only up-to-date copy. A miss moves it back into the
+    // page table before taking it out of the cache, so it cannot slip away while the shard latch is held.
+    IOCategoryScope io_category(IOCategory::CHECKPOINT);
+    return compressed_cache_ != nullptr && compressed_cache_->Flush(page_id);
+  }
+  Page *p_page = GetFrame(iter->second);
+  shard.loaded_cv_.wait(lock, [p_page] { return !p_page->is_loading_; });
+  if (p_page->page_id_ != page_id) {
+    // The page failed to load.
     return false;
   }
-  frame_id = iter->second;
-  p_page = &pages_[frame_id];
+  // Clear the flag before writing so that a concurrent unpin marking the page dirty is not lost.
+  p_page->is_dirty_ = false;
+  IOCategoryScope io_category(IOCategory::CHECKPOINT);
   disk_manager_->WritePage(page_id, p_page->GetData());
-  p_page->is_dirty_ = false;  //
+  num_flushes_.Add();
   return true;
 }
 
 void BufferPoolManagerInstance::FlushAllPgsImp() {
   // You can do it!
-  size_t i;
-  for (i = 0; i < pool_size_; i++) {
-    FlushPage(pages_[i].GetPageId());
+  std::vector<Page *> pages = PinDirtyPages();
+  std::vector<page_id_t> page_ids;
+  std::vector<const char *> page_data;
+  for (Page *p_page : pages) {
+    page_ids.push_back(p_page->GetPageId());
+    page_data.push_back(p_page->GetData());
+  }
+  IOCategoryScope io_category(IOCategory::CHECKPOINT);
+  disk_manager_->WritePages(page_ids, page_data);
+  UnpinFlushedPages(pages);
+}
+
+auto BufferPoolManagerInstance::SetMappedReadsImp(bool enabled) -> bool {
+  if (!enabled) {
+    disk_manager_->UnmapDataFiles();
+    return true;
+  }
+  // The mapping only sees pages that have reached the files.
+  FlushAllPgsImp();
+  return disk_manager_->MapDataFiles();
+}
+
+auto BufferPoolManagerInstance::PinDirtyPages() -> std::vector<Page *> {
+  std::vector<Page *> pages;
+  // Once pinned, a frame cannot be claimed by a shrink, so the resize latch is not held while writing.
+  auto resize_lock = std::shared_lock(resize_latch_);
+  for (size_t i = 0; i < num_frame_ids_; i++) {
+    Page *p_page = GetFrame(i);
+    page_id_t page_id = p_page == nullptr ? INVALID_PAGE_ID : p_page->GetPageId();
+    if (page_id == INVALID_PAGE_ID || !p_page->is_dirty_) {
+      continue;
+    }
+    auto &shard = GetShard(page_id);
+    auto lock = std::shared_lock(shard.latch_);
+    auto iter = shard.page_table_.find(page_id);
+    if (iter == shard.page_table_.end() || iter->second != static_cast<frame_id_t>(i)) {
+      continue;
+    }
+    shard.loaded_cv_.wait(lock, [p_page] { return !p_page->is_loading_; });
+    if (p_page->page_id_ != page_id) {
+      continue;
+    }
+    // Pin the page without telling the replacer, as the background writer does, so that it keeps its place in the
+    // eviction order. Clear the flag before writing so that a concurrent unpin marking the page dirty is not lost.
+    p_page->pin_count_++;
+    p_page->is_dirty_ = false;
+    pages.push_back(p_page);
+  }
+  return pages;
+}
+
+void BufferPoolManagerInstance::UnpinFlushedPages(const std::vector<Page *> &pages) {
+  for (Page *p_page : pages) {
+    auto &shard = GetShard(p_page->GetPageId());
+    auto lock = std::shared_lock(shard.latch_);
+    frame_id_t frame_id = shard.page_table_.at(p_page->GetPageId());
+    if (p_page->pin_count_.fetch_sub(1) == 1) {
+      replacer_->Unpin(frame_id);
+    }
+  }
+  num_flushes_.Add(pages.size());
+  if (compressed_cache_ != nullptr) {
+    compressed_cache_->FlushAll();
   }
 }
 
@@ -78,40 +685,32 @@ auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) -> Page * {
   // 3.   Update P's metadata, zero out memory and add P to the page table.
   // 4.   Set the page ID output parameter. Return a pointer to P.
   frame_id_t frame_id = -1;
-  Page *p_page = nullptr;
-  auto lock = std::lock_guard(latch_);
-
-  if (!free_list_.empty()) {
-    frame_id = *free_list_.begin();
-    free_list_.pop_front();
-  } else {
-    if (replacer_->Victim(&frame_id)) {
-      page_table_.erase(pages_[frame_id].GetPageId());
-      if (pages_[frame_id].IsDirty()) {
-        disk_manager_->WritePage(pages_[frame_id].GetPageId(), pages_[frame_id].GetData());
-      }
-    }
-  }
-  if (frame_id == -1) {
+  if (!AcquireFrame(&frame_id)) {
     return nullptr;
   }
   *page_id = AllocatePage();
-  p_page = &pages_[frame_id];
+  Page *p_page = GetFrame(frame_id);
   p_page->ResetMemory();
-  disk_manager_->WritePage(*page_id, p_page->GetData());
+  // The page only exists in memory until it is first written back, which happens on eviction or flush since it is
+  // created dirty.
+  disk_manager_->AllocatePage(*page_id);
 
+  auto &shard = GetShard(*page_id);
+  auto lock = std::unique_lock(shard.latch_, std::defer_lock);
+  LockTimed(&lock);
   p_page->page_id_ = *page_id;
-  p_page->pin_count_++;
-  p_page->is_dirty_ = false;
-
-  page_table_[*page_id] = frame_id;
-
-  replacer_->Pin(frame_id);
-
+  p_page->pin_count_ = 1;
+  p_page->is_dirty_ = true;
+  BUSTUB_ASSERT(shard.page_table_.count(*page_id) == 0, "A new page id is already mapped to a frame");
+  shard.page_table_[*page_id] = frame_id;
+  replacer_->RecordAccess(frame_id);
+  num_new_pages_.Add();
   return p_page;
 }
 
-auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) -> Page * {
+auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) -> Page * { return FetchPgImp(page_id, nullptr); }
+
+auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * {
   // 1.     Search the page table for the requested page (P).
   // 1.1    If P exists, pin it and return it immediately.
   // 1.2    If P does not exist, find a replacement page (R) from either the free list or the replacer.
@@ -119,46 +718,237 @@ auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) -> Page * {
   // 2.     If R is dirty, write it back to the disk.
   // 3.     Delete R from the page table and insert P.
   // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
+  auto &shard = GetShard(page_id);
+  {
+    auto lock = std::shared_lock(shard.latch_, std::defer_lock);
+    LockTimed(&lock);
+    auto iter = shard.page_table_.find(page_id);
+    if (iter != shard.page_table_.end()) {
+      num_hits_.Add();
+      return PinFrame(&shard, &lock, iter->second);
+    }
+  }
+
+  // The page is not cached. No latch is held while a frame is found, so concurrent hits are never blocked by it.
   frame_id_t frame_id = -1;
-  Page *p_page = nullptr;
-  auto lock = std::lock_guard(latch_);
-  auto iter = page_table_.find(page_id);
-  // The page is not cached
-  if (iter == page_table_.end()) {
-    // Find a new Page from free list.
-    if (!free_list_.empty()) {
-      frame_id = *free_list_.begin();
-      free_list_.pop_front();
-    } else {
-      // Create a new Page using LRU.
-      if (replacer_->Victim(&frame_id)) {
-        page_table_.erase(pages_[frame_id].GetPageId());
-        if (pages_[frame_id].IsDirty()) {
-          disk_manager_->WritePage(pages_[frame_id].GetPageId(), pages_[frame_id].GetData());
-        }
-      }
+  if (!AcquireFrame(&frame_id, strategy)) {
+    return nullptr;
+  }
+  Page *p_page = GetFrame(frame_id);
+  {
+    auto lock = std::unique_lock(shard.latch_, std::defer_lock);
+    LockTimed(&lock);
+    auto iter = shard.page_table_.find(page_id);
+    if (iter != shard.page_table_.end()) {
+      // Another thread brought the page in while we were looking for a frame.
+      ReleaseFrame(frame_id);
+      num_hits_.Add();
+      return PinFrame(&shard, &lock, iter->second);
     }
-    if (frame_id == -1) {
-      return nullptr;
+    p_page->page_id_ = page_id;
+    p_page->pin_count_ = 1;
+    p_page->is_dirty_ = false;
+    p_page->is_loading_ = true;
+    shard.page_table_[page_id] = frame_id;
+    replacer_->RecordAccess(frame_id);
+  }
+  if (strategy != nullptr) {
+    strategy->rings_[this].emplace_back(frame_id, page_id);
+  }
+
+  // Read the page without holding the shard latch; concurrent fetches of this page wait on loaded_cv_.
+  num_misses_.Add();
+  const bool loaded = ReadPageIn(page_id, p_page);
+  FinishLoading(frame_id, page_id, loaded);
+  return loaded ? p_page : nullptr;
+}
+
+auto BufferPoolManagerInstance::FetchPgsImp(const std::vector<page_id_t> &page_ids) -> std::vector<Page *> {
+  std::vector<Page *> pages(page_ids.size(), nullptr);
+  std::vector<frame_id_t> frame_ids(page_ids.size(), -1);
+  std::vector<size_t> misses;
+  // Pin every page first, reserving frames for the misses. Pages that are still loading, possibly because they are
+  // listed earlier in this batch, are only waited for once the batch has been read.
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    page_id_t page_id = page_ids[i];
+    auto &shard = GetShard(page_id);
+    {
+      auto lock = std::shared_lock(shard.latch_, std::defer_lock);
+      LockTimed(&lock);
+      auto iter = shard.page_table_.find(page_id);
+      if (iter != shard.page_table_.end()) {
+        num_hits_.Add();
+        frame_ids[i] = iter->second;
+        pages[i] = PinResidentFrame(iter->second);
+        continue;
+      }
     }
-    p_page = &pages_[frame_id];
-    disk_manager_->ReadPage(page_id, p_page->GetData());
 
+    frame_id_t frame_id = -1;
+    if (!AcquireFrame(&frame_id)) {
+      continue;
+    }
+    Page *p_page = GetFrame(frame_id);
+    auto lock = std::unique_lock(shard.latch_, std::defer_lock);
+    LockTimed(&lock);
+    auto iter = shard.page_table_.find(page_id);
+    if (iter != shard.page_table_.end()) {
+      ReleaseFrame(frame_id);
+      num_hits_.Add();
+      frame_ids[i] = iter->second;
+      pages[i] = PinResidentFrame(iter->second);
+      continue;
+    }
     p_page->page_id_ = page_id;
-    p_page->pin_count_++;
+    p_page->pin_count_ = 1;
     p_page->is_dirty_ = false;
+    p_page->is_loading_ = true;
+    shard.page_table_[page_id] = frame_id;
+    replacer_->RecordAccess(frame_id);
+    frame_ids[i] = frame_id;
+    pages[i] = p_page;
+    misses.push_back(i);
+  }
 
-    page_table_[page_id] = frame_id;
+  // Only the misses that the compressed page cache cannot serve go to disk.
+  num_misses_.Add(misses.size());
+  std::vector<size_t> reads;
+  std::vector<page_id_t> read_page_ids;
+  std::vector<char *> read_page_data;
+  for (size_t i : misses) {
+    if (!TakeFromCompressedCache(page_ids[i], pages[i])) {
+      reads.push_back(i);
+      read_page_ids.push_back(page_ids[i]);
+      read_page_data.push_back(pages[i]->GetData());
+    }
+  }
+  IOCategoryScope io_category(IOCategory::BUFFER_MISS);
+  const std::vector<bool> read = disk_manager_->ReadPages(read_page_ids, read_page_data);
+  std::vector<bool> loaded(page_ids.size(), true);
+  for (size_t j = 0; j < reads.size(); j++) {
+    loaded[reads[j]] = read[j];
+  }
+  for (size_t i : misses) {
+    FinishLoading(frame_ids[i], page_ids[i], loaded[i]);
+    if (!loaded[i]) {
+      pages[i] = nullptr;
+    }
+  }
 
-    replacer_->Pin(frame_id);
+  // Wait for the pages that concurrent misses are still reading in.
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    if (pages[i] != nullptr) {
+      Page *p_page = pages[i];
+      auto &shard = GetShard(page_ids[i]);
+      auto lock = std::shared_lock(shard.latch_);
+      shard.loaded_cv_.wait(lock, [p_page] { return !p_page->is_loading_; });
+      if (p_page->page_id_ != page_ids[i]) {
+        UnpinFailedFrame(frame_ids[i]);
+        pages[i] = nullptr;
+      }
+    }
+  }
+  return pages;
+}
 
-  } else {
-    frame_id = iter->second;
-    p_page = &pages_[frame_id];
-    p_page->pin_count_++;
-    replacer_->Pin(frame_id);
+void BufferPoolManagerInstance::PrefetchPgsImp(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy) {
+  for (page_id_t page_id : page_ids) {
+    auto &shard = GetShard(page_id);
+    {
+      auto lock = std::shared_lock(shard.latch_);
+      if (shard.page_table_.find(page_id) != shard.page_table_.end()) {
+        continue;
+      }
+    }
+
+    frame_id_t frame_id = -1;
+    if (!AcquireFrame(&frame_id, strategy)) {
+      return;
+    }
+    Page *p_page = GetFrame(frame_id);
+    {
+      auto lock = std::lock_guard(shard.latch_);
+      if (shard.page_table_.find(page_id) != shard.page_table_.end()) {
+        ReleaseFrame(frame_id);
+        continue;
+      }
+      // The page stays pinned while it is loading so the frame cannot be taken away. Fetches that arrive before the
+      // read completes wait on loaded_cv_ exactly as they do for a synchronous miss.
+      p_page->page_id_ = page_id;
+      p_page->pin_count_ = 1;
+      p_page->is_dirty_ = false;
+      p_page->is_loading_ = true;
+      shard.page_table_[page_id] = frame_id;
+    }
+    if (strategy != nullptr) {
+      strategy->rings_[this].emplace_back(frame_id, page_id);
+    }
+
+    {
+      auto lock = std::lock_guard(prefetch_latch_);
+      if (prefetch_thread_ == nullptr) {
+        prefetch_running_ = true;
+        prefetch_thread_ = new std::thread(&BufferPoolManagerInstance::PrefetchLoop, this);
+      }
+      prefetch_queue_.emplace_back(frame_id, page_id);
+    }
+    num_prefetches_.Add();
+    prefetch_cv_.notify_one();
+  }
+}
+
+void BufferPoolManagerInstance::PrefetchLoop() {
+  auto lock = std::unique_lock(prefetch_latch_);
+  while (true) {
+    prefetch_cv_.wait(lock, [this] { return !prefetch_queue_.empty() || !prefetch_running_; });
+    if (prefetch_queue_.empty()) {
+      return;
+    }
+    // Everything queued so far is read as one batch, which an asynchronous disk manager keeps in flight at once.
+    std::vector<std::pair<frame_id_t, page_id_t>> prefetches(prefetch_queue_.begin(), prefetch_queue_.end());
+    prefetch_queue_.clear();
+    lock.unlock();
+    CompletePrefetches(prefetches);
+    lock.lock();
+  }
+}
+
+void BufferPoolManagerInstance::CompletePrefetches(const std::vector<std::pair<frame_id_t, page_id_t>> &prefetches) {
+  std::vector<size_t> reads;
+  std::vector<page_id_t> read_page_ids;
+  std::vector<char *> read_page_data;
+  for (size_t i = 0; i < prefetches.size(); i++) {
+    const auto &[frame_id, page_id] = prefetches[i];
+    Page *p_page = GetFrame(frame_id);
+    if (!TakeFromCompressedCache(page_id, p_page)) {
+      reads.push_back(i);
+      read_page_ids.push_back(page_id);
+      read_page_data.push_back(p_page->GetData());
+    }
+  }
+  IOCategoryScope io_category(IOCategory::BUFFER_MISS);
+  const std::vector<bool> read = disk_manager_->ReadPages(read_page_ids, read_page_data);
+  std::vector<bool> loaded(prefetches.size(), true);
+  for (size_t j = 0; j < reads.size(); j++) {
+    loaded[reads[j]] = read[j];
+  }
+  for (size_t i = 0; i < prefetches.size(); i++) {
+    const auto &[frame_id, page_id] = prefetches[i];
+    if (!loaded[i]) {
+      FinishLoading(frame_id, page_id, false);
+      continue;
+    }
+    Page *p_page = GetFrame(frame_id);
+    auto &shard = GetShard(page_id);
+    {
+      auto lock = std::lock_guard(shard.latch_);
+      p_page->is_loading_ = false;
+      if (p_page->pin_count_.fetch_sub(1) == 1) {
+        replacer_->Unpin(frame_id);
+      }
+    }
+    shard.loaded_cv_.notify_all();
   }
-  return p_page;
 }
 
 auto BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) -> bool {
@@ -167,58 +957,78 @@ auto BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) -> bool {
   // 1.   If P does not exist, return true.
   // 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
   // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
+  auto &shard = GetShard(page_id);
   frame_id_t frame_id = -1;
-  Page *p_page = nullptr;
-  auto lock = std::lock_guard(latch_);
-  auto iter = page_table_.find(page_id);
-  if (iter == page_table_.end()) {
-    return true;
-  }
-  frame_id = iter->second;
-  p_page = &pages_[frame_id];
+  {
+    auto lock = std::lock_guard(shard.latch_);
+    auto iter = shard.page_table_.find(page_id);
+    if (iter == shard.page_table_.end()) {
+      if (compressed_cache_ != nullptr) {
+        compressed_cache_->Erase(page_id);
+      }
+      DeallocatePage(page_id);
+      return true;
+    }
+    frame_id = iter->second;
+    Page *p_page = GetFrame(frame_id);
+    if (p_page->pin_count_ > 0) {
+      return false;
+    }
 
-  if (p_page->pin_count_ > 0) {
-    return false;
+    shard.page_table_.erase(iter);
+    replacer_->Remove(frame_id);
+    p_page->page_id_ = INVALID_PAGE_ID;
+    p_page->pin_count_ = 0;
+    p_page->is_dirty_ = false;
   }
 
-  page_table_.erase(page_id);
-  // p_page->ResetMemory();
-  p_page->page_id_ = INVALID_PAGE_ID;
-  p_page->pin_count_ = 0;
-  p_page->is_dirty_ = false;
-
   DeallocatePage(page_id);
-  free_list_.emplace_back(frame_id);
+  ReleaseFrame(frame_id);
   return true;
 }
 
 auto BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool {
-  frame_id_t frame_id = -1;
-  Page *p_page = nullptr;
-  auto lock = std::lock_guard(latch_);
-  auto iter = page_table_.find(page_id);
-  if (iter == page_table_.end()) {
+  auto &shard = GetShard(page_id);
+  auto lock = std::shared_lock(shard.latch_, std::defer_lock);
+  LockTimed(&lock);
+  auto iter = shard.page_table_.find(page_id);
+  if (iter == shard.page_table_.end()) {
     return false;
   }
 
-  frame_id = iter->second;
-  p_page = &pages_[frame_id];
+  frame_id_t frame_id = iter->second;
+  Page *p_page = GetFrame(frame_id);
   if (is_dirty) {
     p_page->is_dirty_ = true;
   }
-  if (p_page->pin_count_ == 0) {
-    return false;
-  }
-  p_page->pin_count_--;
-  if (p_page->pin_count_ == 0) {
+  int pin_count = p_page->pin_count_;
+  do {
+    if (pin_count <= 0) {
+      return false;
+    }
+  } while (!p_page->pin_count_.compare_exchange_weak(pin_count, pin_count - 1));
+  if (pin_count == 1) {
     replacer_->Unpin(frame_id);
   }
   return true;
 }
 
 auto BufferPoolManagerInstance::AllocatePage() -> page_id_t {
-  const page_id_t next_page_id = next_page_id_;
-  next_page_id_ += num_instances_;
+  {
+    auto lock = std::lock_guard(free_page_ids_latch_);
+    if (free_page_ids_.empty()) {
+      free_page_ids_ = disk_manager_->AllocateFreePages(num_instances_, instance_index_, FREE_PAGE_EXTENT_SIZE);
+      std::reverse(free_page_ids_.begin(), free_page_ids_.end());
+    }
+    if (!free_page_ids_.empty()) {
+      const page_id_t page_id = free_page_ids_.back();
+      free_page_ids_.pop_back();
+      ValidatePageId(page_id);
+      return page_id;
+    }
+  }
+  // NewPage allocates without holding a latch, so the id has to be claimed in a single atomic step.
+  const page_id_t next_page_id = next_page_id_.fetch_add(num_instances_);
   ValidatePageId(next_page_id);
   return next_page_id;
 }
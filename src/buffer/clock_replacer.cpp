@@ -12,18 +12,106 @@
 
 #include "buffer/clock_replacer.h"
 
+#include <algorithm>
+
+#include "common/macros.h"
+
 namespace bustub {
 
-ClockReplacer::ClockReplacer(size_t num_pages) {}
+ClockReplacer::ClockReplacer(size_t num_pages) : segment_size_(std::max<size_t>(1, num_pages)) {
+  SetCapacity(segment_size_);
+}
+
+ClockReplacer::~ClockReplacer() {
+  for (auto *segment : segments_) {
+    delete[] segment;
+  }
+}
+
+auto ClockReplacer::GetState(frame_id_t frame_id) -> std::atomic<uint8_t> & {
+  BUSTUB_ASSERT(frame_id >= 0 && static_cast<size_t>(frame_id) < capacity_.load(std::memory_order_acquire),
+                "Frame id out of range");
+  // Segment i holds segment_size_ * 2^i frames, following the segment_size_ * (2^i - 1) before it.
+  const size_t segment = 63 - __builtin_clzll(frame_id / segment_size_ + 1);
+  return segments_[segment][frame_id - segment_size_ * ((size_t{1} << segment) - 1)];
+}
+
+auto ClockReplacer::Victim(frame_id_t *frame_id) -> bool {
+  // Every lap clears the reference bits it passes, so a victim is found within two laps unless concurrent unpins
+  // keep referencing frames.
+  while (size_.load(std::memory_order_relaxed) > 0) {
+    const size_t capacity = capacity_.load(std::memory_order_acquire);
+    const auto candidate = static_cast<frame_id_t>(hand_.fetch_add(1, std::memory_order_relaxed) % capacity);
+    auto &state = GetState(candidate);
+    uint8_t expected = state.load(std::memory_order_relaxed);
+    if ((expected & EVICTABLE) == 0) {
+      continue;
+    }
+    if ((expected & REFERENCED) != 0) {
+      state.fetch_and(static_cast<uint8_t>(~REFERENCED), std::memory_order_relaxed);
+      continue;
+    }
+    // Fails if the frame was pinned or referenced since it was loaded; the hand then just moves on.
+    if (state.compare_exchange_strong(expected, 0, std::memory_order_acq_rel)) {
+      size_.fetch_sub(1, std::memory_order_relaxed);
+      *frame_id = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+void ClockReplacer::Pin(frame_id_t frame_id) {
+  if ((GetState(frame_id).fetch_and(static_cast<uint8_t>(~EVICTABLE), std::memory_order_acq_rel) & EVICTABLE) != 0) {
+    size_.fetch_sub(1, std::memory_order_relaxed);
+  }
+}
 
-ClockReplacer::~ClockReplacer() = default;
+void ClockReplacer::Unpin(frame_id_t frame_id) {
+  if ((GetState(frame_id).fetch_or(EVICTABLE | REFERENCED, std::memory_order_acq_rel) & EVICTABLE) == 0) {
+    size_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
 
-auto ClockReplacer::Victim(frame_id_t *frame_id) -> bool { return false; }
+void ClockReplacer::RecordAccess(frame_id_t frame_id) {
+  GetState(frame_id).fetch_or(REFERENCED, std::memory_order_relaxed);
+}
 
-void ClockReplacer::Pin(frame_id_t frame_id) {}
+void ClockReplacer::SetCapacity(size_t num_pages) {
+  // Callers never grow the replacer concurrently, and only use the new frame ids once this returns.
+  size_t capacity = capacity_.load(std::memory_order_relaxed);
+  for (size_t segment = 0; capacity < num_pages; segment++) {
+    BUSTUB_ASSERT(segment < NUM_SEGMENTS, "Too many frames in the replacer");
+    if (segments_[segment] != nullptr) {
+      continue;
+    }
+    const size_t segment_size = segment_size_ << segment;
+    segments_[segment] = new std::atomic<uint8_t>[segment_size];
+    for (size_t i = 0; i < segment_size; i++) {
+      segments_[segment][i].store(0, std::memory_order_relaxed);
+    }
+    capacity += segment_size;
+    capacity_.store(capacity, std::memory_order_release);
+  }
+}
 
-void ClockReplacer::Unpin(frame_id_t frame_id) {}
+auto ClockReplacer::GetEvictionOrder() -> std::vector<frame_id_t> {
+  // Starting at the hand, unreferenced frames go first; referenced ones only once the hand has cleared their bit.
+  const size_t capacity = capacity_.load(std::memory_order_acquire);
+  const size_t hand = hand_.load(std::memory_order_relaxed);
+  std::vector<frame_id_t> frame_ids;
+  std::vector<frame_id_t> referenced;
+  for (size_t i = 0; i < capacity; i++) {
+    const auto frame_id = static_cast<frame_id_t>((hand + i) % capacity);
+    const uint8_t state = GetState(frame_id).load(std::memory_order_relaxed);
+    if ((state & EVICTABLE) != 0) {
+      ((state & REFERENCED) != 0 ? referenced : frame_ids).push_back(frame_id);
+    }
+  }
+  frame_ids.insert(frame_ids.end(), referenced.begin(), referenced.end());
+  return frame_ids;
+}
 
-auto ClockReplacer::Size() -> size_t { return 0; }
+auto ClockReplacer::Size() -> size_t { return size_.load(std::memory_order_relaxed); }
 
 }  // namespace bustub
@@ -0,0 +1,236 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_cache.cpp
+//
+// Identification: src/buffer/compressed_page_cache.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/compressed_page_cache.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace bustub {
+
+namespace {
+
+/** Tokens below this value start a literal run of token + 1 bytes; the others start a match. */
+constexpr uint8_t MATCH_TOKEN = 0x80;
+constexpr size_t MAX_LITERAL_RUN = MATCH_TOKEN;
+constexpr size_t MIN_MATCH = 4;
+constexpr size_t MAX_MATCH = MIN_MATCH + 0x7f;
+constexpr size_t MAX_OFFSET = 0xffff;
+constexpr size_t HASH_BITS = 12;
+
+void EmitLiterals(const char *data, size_t size, std::string *compressed) {
+  while (size > 0) {
+    size_t run = std::min(size, MAX_LITERAL_RUN);
+    compressed->push_back(static_cast<char>(run - 1));
+    compressed->append(data, run);
+    data += run;
+    size -= run;
+  }
+}
+
+}  // namespace
+
+CompressedPageCache::CompressedPageCache(size_t capacity, DiskManager *disk_manager)
+    : capacity_(capacity), disk_manager_(disk_manager) {}
+
+void CompressedPageCache::Compress(const char *data, size_t size, std::string *compressed) {
+  compressed->clear();
+  // Most recent position of each hashed 4-byte sequence, -1 if none.
+  std::array<int64_t, size_t{1} << HASH_BITS> positions;
+  positions.fill(-1);
+  size_t pos = 0;
+  size_t literal_start = 0;
+  while (pos + MIN_MATCH <= size) {
+    uint32_t sequence;
+    memcpy(&sequence, data + pos, sizeof(sequence));
+    const size_t hash = (sequence * 2654435761U) >> (32 - HASH_BITS);
+    const int64_t candidate = positions[hash];
+    positions[hash] = static_cast<int64_t>(pos);
+    if (candidate < 0 || pos - candidate > MAX_OFFSET || memcmp(data + candidate, data + pos, MIN_MATCH) != 0) {
+      pos++;
+      continue;
+    }
+    size_t length = MIN_MATCH;
+    while (pos + length < size && length < MAX_MATCH && data[candidate + length] == data[pos + length]) {
+      length++;
+    }
+    EmitLiterals(data + literal_start, pos - literal_start, compressed);
+    const size_t offset = pos - candidate;
+    compressed->push_back(static_cast<char>(MATCH_TOKEN | (length - MIN_MATCH)));
+    compressed->push_back(static_cast<char>(offset & 0xff));
+    compressed->push_back(static_cast<char>(offset >> 8));
+    pos += length;
+    literal_start = pos;
+  }
+  EmitLiterals(data + literal_start, size - literal_start, compressed);
+}
+
+auto CompressedPageCache::Decompress(const std::string &compressed, char *data, size_t size) -> bool {
+  size_t in = 0;
+  size_t out = 0;
+  while (in < compressed.size()) {
+    const auto token = static_cast<uint8_t>(compressed[in++]);
+    if (token < MATCH_TOKEN) {
+      const size_t run = token + 1;
+      if (in + run > compressed.size() || out + run > size) {
+        return false;
+      }
+      memcpy(data + out, compressed.data() + in, run);
+      in += run;
+      out += run;
+      continue;
+    }
+    if (in + 2 > compressed.size()) {
+      return false;
+    }
+    const size_t length = (token & 0x7f) + MIN_MATCH;
+    const size_t offset = static_cast<uint8_t>(compressed[in]) | (static_cast<uint8_t>(compressed[in + 1]) << 8);
+    in += 2;
+    if (offset == 0 || offset > out || out + length > size) {
+      return false;
+    }
+    // Byte by byte, since the match may overlap the bytes it produces.
+    for (size_t i = 0; i < length; i++, out++) {
+      data[out] = data[out - offset];
+    }
+  }
+  return out == size;
+}
+
+void CompressedPageCache::Restore(const Entry &entry, char *page_data) {
+  if (!entry.is_compressed_) {
+    memcpy(page_data, entry.data_.data(), PAGE_SIZE);
+    return;
+  }
+  bool ok = Decompress(entry.data_, page_data, PAGE_SIZE);
+  BUSTUB_ASSERT(ok, "Corrupt compressed page");
+}
+
+void CompressedPageCache::Insert(page_id_t page_id, const char *page_data, bool is_dirty) {
+  Entry entry;
+  Compress(page_data, PAGE_SIZE, &entry.data_);
+  entry.is_compressed_ = entry.data_.size() < PAGE_SIZE;
+  if (!entry.is_compressed_) {
+    entry.data_.assign(page_data, PAGE_SIZE);
+  }
+  entry.is_dirty_ = is_dirty;
+
+  auto lock = std::lock_guard(latch_);
+  auto iter = entries_.find(page_id);
+  if (iter != entries_.end()) {
+    // The older copy is superseded, so it never needs to be written back.
+    size_ -= iter->second.data_.size();
+    lru_.erase(iter->second.lru_iter_);
+    entries_.erase(iter);
+  }
+  if (entry.data_.size() > capacity_) {
+    if (is_dirty) {
+      disk_manager_->WritePage(page_id, page_data);
+    }
+    return;
+  }
+  while (size_ + entry.data_.size() > capacity_) {
+    Evict(entries_.find(lru_.back()));
+  }
+  size_ += entry.data_.size();
+  lru_.push_front(page_id);
+  entry.lru_iter_ = lru_.begin();
+  entries_.emplace(page_id, std::move(entry));
+}
+
+auto CompressedPageCache::Take(page_id_t page_id, char *page_data, bool *is_dirty) -> bool {
+  auto lock = std::lock_guard(latch_);
+  auto iter = entries_.find(page_id);
+  if (iter == entries_.end()) {
+    num_misses_.Add();
+    return false;
+  }
+  num_hits_.Add();
+  Restore(iter->second, page_data);
+  *is_dirty = iter->second.is_dirty_;
+  size_ -= iter->second.data_.size();
+  lru_.erase(iter->second.lru_iter_);
+  entries_.erase(iter);
+  return true;
+}
+
+void CompressedPageCache::Erase(page_id_t page_id) {
+  auto lock = std::lock_guard(latch_);
+  auto iter = entries_.find(page_id);
+  if (iter != entries_.end()) {
+    size_ -= iter->second.data_.size();
+    lru_.erase(iter->second.lru_iter_);
+    entries_.erase(iter);
+  }
+}
+
+auto CompressedPageCache::Flush(page_id_t page_id) -> bool {
+  auto lock = std::lock_guard(latch_);
+  auto iter = entries_.find(page_id);
+  if (iter == entries_.end()) {
+    return false;
+  }
+  if (iter->second.is_dirty_) {
+    char page_data[PAGE_SIZE];
+    Restore(iter->second, page_data);
+    disk_manager_->WritePage(page_id, page_data);
+    iter->second.is_dirty_ = false;
+  }
+  return true;
+}
+
+void CompressedPageCache::FlushAll() {
+  auto lock = std::lock_guard(latch_);
+  std::vector<Entry *> dirty_entries;
+  std::vector<page_id_t> page_ids;
+  for (auto &[page_id, entry] : entries_) {
+    if (entry.is_dirty_) {
+      dirty_entries.push_back(&entry);
+      page_ids.push_back(page_id);
+    }
+  }
+  // Restore the dirty pages side by side so that they are written back in one batch.
+  std::vector<char> buffer(page_ids.size() * PAGE_SIZE);
+  std::vector<const char *> page_data(page_ids.size());
+  for (size_t i = 0; i < dirty_entries.size(); i++) {
+    Restore(*dirty_entries[i], &buffer[i * PAGE_SIZE]);
+    page_data[i] = &buffer[i * PAGE_SIZE];
+    dirty_entries[i]->is_dirty_ = false;
+  }
+  disk_manager_->WritePages(page_ids, page_data);
+}
+
+auto CompressedPageCache::GetSize() -> size_t {
+  auto lock = std::lock_guard(latch_);
+  return size_;
+}
+
+auto CompressedPageCache::GetNumPages() -> size_t {
+  auto lock = std::lock_guard(latch_);
+  return entries_.size();
+}
+
+void CompressedPageCache::Evict(std::unordered_map<page_id_t, Entry>::iterator iter) {
+  if (iter->second.is_dirty_) {
+    char page_data[PAGE_SIZE];
+    Restore(iter->second, page_data);
+    disk_manager_->WritePage(iter->first, page_data);
+  }
+  size_ -= iter->second.data_.size();
+  lru_.erase(iter->second.lru_iter_);
+  entries_.erase(iter);
+}
+
+}  // namespace bustub
@@ -0,0 +1,143 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.cpp
+//
+// Identification: src/buffer/lru_k_replacer.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/lru_k_replacer.h"
+
+#include "common/macros.h"
+
+namespace bustub {
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k, size_t correlated_reference_period)
+    : num_pages_(num_pages), k_(k), correlated_reference_period_(correlated_reference_period) {
+  BUSTUB_ASSERT(k > 0, "LRU-K needs to look back at least one reference");
+}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+auto LRUKReplacer::KeyOf(frame_id_t frame_id, const FrameHistory &frame) const -> EvictionKey {
+  if (frame.history_.size() < k_) {
+    // Infinite backward K-distance, fall back to LRU on the most recent reference.
+    return {false, frame.history_.front(), frame_id};
+  }
+  return {true, frame.history_[k_ - 1], frame_id};
+}
+
+void LRUKReplacer::Access(frame_id_t frame_id, FrameHistory *frame) {
+  current_timestamp_++;
+  if (frame->evictable_) {
+    evictable_.erase(KeyOf(frame_id, *frame));
+  }
+  if (frame->history_.empty()) {
+    frame->history_.push_front(current_timestamp_);
+  } else if (current_timestamp_ - frame->last_access_ > correlated_reference_period_) {
+    // A new, uncorrelated reference. The previous burst of correlated references counts as a single reference at
+    // its start, so older history is moved forward by the length of that burst.
+    size_t correlated_period = frame->last_access_ - frame->history_.front();
+    for (auto &timestamp : frame->history_) {
+      timestamp += correlated_period;
+    }
+    frame->history_.push_front(current_timestamp_);
+    if (frame->history_.size() > k_) {
+      frame->history_.pop_back();
+    }
+  }
+  frame->last_access_ = current_timestamp_;
+  if (frame->evictable_) {
+    evictable_.insert(KeyOf(frame_id, *frame));
+  }
+}
+
+auto LRUKReplacer::Victim(frame_id_t *frame_id) -> bool {
+  auto lock = std::lock_guard(mutex_);
+  if (evictable_.empty()) {
+    return false;
+  }
+  // Frames still inside their correlated reference period are skipped, unless nothing else can be evicted.
+  auto victim = evictable_.begin();
+  for (auto iter = evictable_.begin(); iter != evictable_.end(); ++iter) {
+    const auto &frame = frames_[std::get<2>(*iter)];
+    if (current_timestamp_ - frame.last_access_ >= correlated_reference_period_) {
+      victim = iter;
+      break;
+    }
+  }
+  *frame_id = std::get<2>(*victim);
+  frames_[*frame_id].evictable_ = false;
+  evictable_.erase(victim);
+  return true;
+}
+
+void LRUKReplacer::Pin(frame_id_t frame_id) {
+  auto lock = std::lock_guard(mutex_);
+  auto iter = frames_.find(frame_id);
+  if (iter != frames_.end() && iter->second.evictable_) {
+    evictable_.erase(KeyOf(frame_id, iter->second));
+    iter->second.evictable_ = false;
+  }
+}
+
+void LRUKReplacer::Unpin(frame_id_t frame_id) {
+  auto lock = std::lock_guard(mutex_);
+  auto iter = frames_.find(frame_id);
+  if (iter == frames_.end()) {
+    if (evictable_.size() >= num_pages_) {
+      return;
+    }
+    // Never referenced through RecordAccess, treat the unpin as its first reference.
+    iter = frames_.emplace(frame_id, FrameHistory()).first;
+    Access(frame_id, &iter->second);
+  }
+  if (!iter->second.evictable_) {
+    iter->second.evictable_ = true;
+    evictable_.insert(KeyOf(frame_id, iter->second));
+  }
+}
+
+void LRUKReplacer::Remove(frame_id_t frame_id) {
+  auto lock = std::lock_guard(mutex_);
+  auto iter = frames_.find(frame_id);
+  if (iter == frames_.end()) {
+    return;
+  }
+  if (iter->second.evictable_) {
+    evictable_.erase(KeyOf(frame_id, iter->second));
+  }
+  frames_.erase(iter);
+}
+
+void LRUKReplacer::RecordAccess(frame_id_t frame_id) {
+  auto lock = std::lock_guard(mutex_);
+  Access(frame_id, &frames_[frame_id]);
+}
+
+void LRUKReplacer::SetCapacity(size_t num_pages) {
+  auto lock = std::lock_guard(mutex_);
+  num_pages_ = num_pages;
+}
+
+auto LRUKReplacer::GetEvictionOrder() -> std::vector<frame_id_t> {
+  auto lock = std::lock_guard(mutex_);
+  // Ignores the correlated reference period, which only postpones the eviction of recently referenced frames.
+  std::vector<frame_id_t> frame_ids;
+  frame_ids.reserve(evictable_.size());
+  for (const auto &key : evictable_) {
+    frame_ids.push_back(std::get<2>(key));
+  }
+  return frame_ids;
+}
+
+auto LRUKReplacer::Size() -> size_t {
+  auto lock = std::lock_guard(mutex_);
+  return evictable_.size();
+}
+
+}  // namespace bustub
@@ -66,6 +66,21 @@ void LRUReplacer::Unpin(frame_id_t frame_id) {
   }
 }
 
+void LRUReplacer::SetCapacity(size_t num_pages) {
+  auto lock = std::lock_guard(mutex_);
+  num_page_ = num_pages;
+}
+
+auto LRUReplacer::GetEvictionOrder() -> std::vector<frame_id_t> {
+  auto lock = std::lock_guard(mutex_);
+  std::vector<frame_id_t> frame_ids;
+  frame_ids.reserve(size_);
+  for (Node *node = lst_->prev_; node != fst_.get(); node = node->prev_) {
+    frame_ids.push_back(node->frame_);
+  }
+  return frame_ids;
+}
+
 auto LRUReplacer::Size() -> size_t {
   auto lock = std::lock_guard(mutex_);
   return size_;
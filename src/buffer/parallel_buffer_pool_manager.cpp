@@ -12,20 +12,29 @@
 
 #include "buffer/parallel_buffer_pool_manager.h"
 
+#include <algorithm>
+#include <future>  // NOLINT
+
 namespace bustub {
 
 ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
-                                                     LogManager *log_manager)
-    : pool_size_(pool_size), num_instances_(num_instances) {
+                                                     LogManager *log_manager, ReplacerType replacer_type)
+    : num_instances_(num_instances), disk_manager_(disk_manager) {
   // Allocate and create individual BufferPoolManagerInstances
   size_t i;
   for (i = 0; i < num_instances; i++) {
-    instances_.emplace_back(new BufferPoolManagerInstance(pool_size, num_instances, i, disk_manager, log_manager));
+    instances_.emplace_back(
+        new BufferPoolManagerInstance(pool_size, num_instances, i, disk_manager, log_manager, replacer_type));
   }
 }
 
 // Update constructor to destruct all BufferPoolManagerInstances and deallocate any associated memory
 ParallelBufferPoolManager::~ParallelBufferPoolManager() {
+  // Frames may have moved between instances, so no instance may touch its frames once any instance is deleted.
+  for (auto *instance : instances_) {
+    instance->StopBackgroundWriter();
+    instance->StopPrefetchThread();
+  }
   size_t i;
   for (i = 0; i < num_instances_; i++) {
     delete instances_[i];
@@ -34,7 +43,81 @@ ParallelBufferPoolManager::~ParallelBufferPoolManager() {
 
 auto ParallelBufferPoolManager::GetPoolSize() -> size_t {
   // Get size of all BufferPoolManagerInstances
-  return instances_.size() * pool_size_;
+  size_t pool_size = 0;
+  for (auto *instance : instances_) {
+    pool_size += instance->GetPoolSize();
+  }
+  return pool_size;
+}
+
+auto ParallelBufferPoolManager::GetStats() -> BufferPoolStats {
+  BufferPoolStats stats;
+  for (auto *instance : instances_) {
+    stats += instance->GetStats();
+  }
+  return stats;
+}
+
+void ParallelBufferPoolManager::ResetStats() {
+  for (auto *instance : instances_) {
+    instance->ResetStats();
+  }
+}
+
+auto ParallelBufferPoolManager::GetResidentPages() -> std::vector<page_id_t> {
+  std::vector<std::vector<page_id_t>> instance_page_ids;
+  size_t num_pages = 0;
+  for (auto *instance : instances_) {
+    instance_page_ids.push_back(instance->GetResidentPages());
+    num_pages += instance_page_ids.back().size();
+  }
+  std::vector<page_id_t> page_ids;
+  page_ids.reserve(num_pages);
+  for (size_t rank = 0; page_ids.size() < num_pages; rank++) {
+    for (const auto &ids : instance_page_ids) {
+      if (rank < ids.size()) {
+        page_ids.push_back(ids[rank]);
+      }
+    }
+  }
+  return page_ids;
+}
+
+auto ParallelBufferPoolManager::ResizeImp(size_t pool_size) -> bool {
+  bool success = true;
+  for (size_t i = 0; i < num_instances_; i++) {
+    size_t instance_pool_size = pool_size / num_instances_ + (i < pool_size % num_instances_ ? 1 : 0);
+    success = instances_[i]->Resize(instance_pool_size) && success;
+  }
+  return success;
+}
+
+auto ParallelBufferPoolManager::SetMappedReadsImp(bool enabled) -> bool {
+  // The instances share the disk manager, so it is mapped once for all of them.
+  if (!enabled) {
+    disk_manager_->UnmapDataFiles();
+    return true;
+  }
+  FlushAllPgsImp();
+  return disk_manager_->MapDataFiles();
+}
+
+void ParallelBufferPoolManager::EnableCompressedCache(size_t capacity) {
+  for (auto *instance : instances_) {
+    instance->EnableCompressedCache(capacity / num_instances_);
+  }
+}
+
+void ParallelBufferPoolManager::RunBackgroundWriters(size_t low_watermark, size_t max_pages_per_round) {
+  for (auto *instance : instances_) {
+    instance->RunBackgroundWriter(low_watermark, max_pages_per_round);
+  }
+}
+
+void ParallelBufferPoolManager::StopBackgroundWriters() {
+  for (auto *instance : instances_) {
+    instance->StopBackgroundWriter();
+  }
 }
 
 auto ParallelBufferPoolManager::GetBufferPoolManager(page_id_t page_id) -> BufferPoolManager * {
@@ -44,7 +127,78 @@ auto ParallelBufferPoolManager::GetBufferPoolManager(page_id_t page_id) -> Buffe
 
 auto ParallelBufferPoolManager::FetchPgImp(page_id_t page_id) -> Page * {
   // Fetch page for page_id from responsible BufferPoolManagerInstance
-  return GetBufferPoolManager(page_id)->FetchPage(page_id);
+  return FetchPgImp(page_id, nullptr);
+}
+
+auto ParallelBufferPoolManager::FetchPgImp(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * {
+  BufferPoolManagerInstance *instance = instances_[page_id % num_instances_];
+  Page *p_page = instance->FetchPage(page_id, strategy);
+  // Every frame of the responsible instance is pinned. Borrow a frame from each sibling in turn until the fetch
+  // succeeds; the borrowed frame stays with the instance that needed it.
+  for (size_t i = 1; p_page == nullptr && i < num_instances_; i++) {
+    Page *frame = instances_[(page_id + i) % num_instances_]->DonateFrame();
+    if (frame == nullptr) {
+      continue;
+    }
+    instance->AdoptFrame(frame);
+    p_page = instance->FetchPage(page_id, strategy);
+  }
+  return p_page;
+}
+
+auto ParallelBufferPoolManager::FetchPgsImp(const std::vector<page_id_t> &page_ids) -> std::vector<Page *> {
+  // Split the batch by instance, remembering where each page goes in the result.
+  std::vector<std::vector<page_id_t>> instance_page_ids(num_instances_);
+  std::vector<std::vector<size_t>> instance_positions(num_instances_);
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    instance_page_ids[page_ids[i] % num_instances_].push_back(page_ids[i]);
+    instance_positions[page_ids[i] % num_instances_].push_back(i);
+  }
+
+  // The instances fetch their shares in parallel; the last one runs on the calling thread.
+  std::vector<std::future<std::vector<Page *>>> futures(num_instances_);
+  std::vector<std::vector<Page *>> instance_pages(num_instances_);
+  size_t last = num_instances_;
+  for (size_t i = 0; i < num_instances_; i++) {
+    if (instance_page_ids[i].empty()) {
+      continue;
+    }
+    if (last != num_instances_) {
+      futures[last] = std::async(std::launch::async, [this, &instance_page_ids, last] {
+        return instances_[last]->FetchPages(instance_page_ids[last]);
+      });
+    }
+    last = i;
+  }
+  if (last != num_instances_) {
+    instance_pages[last] = instances_[last]->FetchPages(instance_page_ids[last]);
+  }
+
+  std::vector<Page *> pages(page_ids.size(), nullptr);
+  for (size_t i = 0; i < num_instances_; i++) {
+    if (futures[i].valid()) {
+      instance_pages[i] = futures[i].get();
+    }
+    for (size_t j = 0; j < instance_pages[i].size(); j++) {
+      // Every frame of the instance is pinned, so fall back to a single fetch that borrows a frame from a sibling.
+      pages[instance_positions[i][j]] =
+          instance_pages[i][j] != nullptr ? instance_pages[i][j] : FetchPgImp(instance_page_ids[i][j], nullptr);
+    }
+  }
+  return pages;
+}
+
+void ParallelBufferPoolManager::PrefetchPgsImp(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy) {
+  // Hand each instance its share of the pages in one call.
+  std::vector<std::vector<page_id_t>> instance_page_ids(num_instances_);
+  for (page_id_t page_id : page_ids) {
+    instance_page_ids[page_id % num_instances_].push_back(page_id);
+  }
+  for (size_t i = 0; i < num_instances_; i++) {
+    if (!instance_page_ids[i].empty()) {
+      instances_[i]->PrefetchPages(instance_page_ids[i], strategy);
+    }
+  }
 }
 
 auto ParallelBufferPoolManager::UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool {
@@ -84,9 +238,43 @@ auto ParallelBufferPoolManager::DeletePgImp(page_id_t page_id) -> bool {
 
 void ParallelBufferPoolManager::FlushAllPgsImp() {
   // flush all pages from all BufferPoolManagerInstances
-  size_t i;
-  for (i = 0; i < num_instances_; i++) {
-    instances_[i]->FlushAllPages();
+  // Consecutive page ids belong to different instances, so their dirty pages are merged before being sorted into runs.
+  IOCategoryScope io_category(IOCategory::CHECKPOINT);
+  std::vector<std::vector<Page *>> instance_pages(num_instances_);
+  std::vector<Page *> pages;
+  for (size_t i = 0; i < num_instances_; i++) {
+    instance_pages[i] = instances_[i]->PinDirtyPages();
+    pages.insert(pages.end(), instance_pages[i].begin(), instance_pages[i].end());
+  }
+  std::sort(pages.begin(), pages.end(), [](Page *a, Page *b) { return a->GetPageId() < b->GetPageId(); });
+
+  // The sorted pages are split into one slice per instance, written in parallel; the last one on the calling thread.
+  const size_t slice_size = (pages.size() + num_instances_ - 1) / num_instances_;
+  std::vector<std::future<void>> futures;
+  for (size_t begin = 0; begin < pages.size(); begin += slice_size) {
+    const size_t end = std::min(pages.size(), begin + slice_size);
+    auto write_slice = [this, &pages, begin, end] {
+      IOCategoryScope io_category(IOCategory::CHECKPOINT);
+      std::vector<page_id_t> page_ids;
+      std::vector<const char *> page_data;
+      for (size_t i = begin; i < end; i++) {
+        page_ids.push_back(pages[i]->GetPageId());
+        page_data.push_back(pages[i]->GetData());
+      }
+      disk_manager_->WritePages(page_ids, page_data);
+    };
+    if (end == pages.size()) {
+      write_slice();
+    } else {
+      futures.push_back(std::async(std::launch::async, write_slice));
+    }
+  }
+  for (auto &future : futures) {
+    future.get();
+  }
+
+  for (size_t i = 0; i < num_instances_; i++) {
+    instances_[i]->UnpinFlushedPages(instance_pages[i]);
   }
 }
 
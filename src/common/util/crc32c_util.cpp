@@ -0,0 +1,100 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c_util.cpp
+//
+// Identification: src/common/util/crc32c_util.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/util/crc32c_util.h"
+
+#include <array>
+#include <cstring>
+
+namespace bustub {
+
+namespace {
+
+/** The CRC32C polynomial, bit-reversed. */
+constexpr uint32_t CRC32C_POLYNOMIAL = 0x82F63B78;
+
+/** Table i maps a byte to its contribution to the checksum when it is followed by i more bytes. */
+constexpr auto MakeSlicingTables() -> std::array<std::array<uint32_t, 256>, 8> {
+  std::array<std::array<uint32_t, 256>, 8> tables{};
+  for (uint32_t byte = 0; byte < 256; byte++) {
+    uint32_t crc = byte;
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ ((crc & 1) != 0 ? CRC32C_POLYNOMIAL : 0);
+    }
+    tables[0][byte] = crc;
+  }
+  for (uint32_t byte = 0; byte < 256; byte++) {
+    for (size_t i = 1; i < 8; i++) {
+      tables[i][byte] = (tables[i - 1][byte] >> 8) ^ tables[0][tables[i - 1][byte] & 0xFF];
+    }
+  }
+  return tables;
+}
+
+constexpr std::array<std::array<uint32_t, 256>, 8> SLICING_TABLES = MakeSlicingTables();
+
+#if defined(__x86_64__)
+
+__attribute__((target("sse4.2"))) auto Crc32cHardware(const char *data, size_t length, uint32_t crc) -> uint32_t {
+  uint64_t crc64 = ~crc;
+  for (; length >= 8; data += 8, length -= 8) {
+    uint64_t word;
+    memcpy(&word, data, sizeof(word));
+    crc64 = __builtin_ia32_crc32di(crc64, word);
+  }
+  auto crc32 = static_cast<uint32_t>(crc64);
+  for (; length > 0; data++, length--) {
+    crc32 = __builtin_ia32_crc32qi(crc32, static_cast<uint8_t>(*data));
+  }
+  return ~crc32;
+}
+
+const bool HAS_SSE42 = __builtin_cpu_supports("sse4.2");
+
+#else
+
+const bool HAS_SSE42 = false;
+
+auto Crc32cHardware(const char *data, size_t length, uint32_t crc) -> uint32_t {
+  return Crc32cUtil::Crc32cSoftware(data, length, crc);
+}
+
+#endif
+
+}  // namespace
+
+auto Crc32cUtil::Crc32c(const char *data, size_t length, uint32_t crc) -> uint32_t {
+  return HAS_SSE42 ? Crc32cHardware(data, length, crc) : Crc32cSoftware(data, length, crc);
+}
+
+auto Crc32cUtil::Crc32cSoftware(const char *data, size_t length, uint32_t crc) -> uint32_t {
+  const auto &t = SLICING_TABLES;
+  crc = ~crc;
+  // Eight bytes per step: the low half is folded into the running checksum, the high half looked up on its own.
+  for (; length >= 8; data += 8, length -= 8) {
+    uint32_t low;
+    uint32_t high;
+    memcpy(&low, data, sizeof(low));
+    memcpy(&high, data + 4, sizeof(high));
+    low ^= crc;
+    crc = t[7][low & 0xFF] ^ t[6][(low >> 8) & 0xFF] ^ t[5][(low >> 16) & 0xFF] ^ t[4][low >> 24] ^
+          t[3][high & 0xFF] ^ t[2][(high >> 8) & 0xFF] ^ t[1][(high >> 16) & 0xFF] ^ t[0][high >> 24];
+  }
+  for (; length > 0; data++, length--) {
+    crc = (crc >> 8) ^ t[0][(crc ^ static_cast<uint8_t>(*data)) & 0xFF];
+  }
+  return ~crc;
+}
+
+auto Crc32cUtil::IsHardwareAccelerated() -> bool { return HAS_SSE42; }
+
+}  // namespace bustub
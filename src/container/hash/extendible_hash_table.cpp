@@ -74,6 +74,13 @@ auto HASH_TABLE_TYPE::FetchDirectoryPage() -> HashTableDirectoryPage * {
   return dir_page;
 }
 
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::FetchRawDirectoryPage() -> std::pair<Page *, HashTableDirectoryPage *> {
+  Page *page = buffer_pool_manager_->FetchPage(directory_page_id_);
+  HashTableDirectoryPage *dir_page = reinterpret_cast<HashTableDirectoryPage *>(page->GetData());
+  return std::pair<Page *, HashTableDirectoryPage *>(page, dir_page);
+}
+
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_id) -> std::pair<Page *, HASH_TABLE_BUCKET_TYPE *> {
   Page *page = buffer_pool_manager_->FetchPage(bucket_page_id);
@@ -86,20 +93,46 @@ auto HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_id) -> std::pair<Pag
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) -> bool {
-  table_latch_.RLock();
   // LOG_INFO("# Search key");
+  // The directory changes only on splits and merges, so it is read optimistically: the bucket lookup is retried if a
+  // split or merge latched the directory page in the meantime. After a few failed attempts, fall back to latching it.
+  // Lookups in flight keep merged buckets from being deleted under them.
+  num_lookups_.fetch_add(1);
+  auto [raw_dir_page, dir_page] = FetchRawDirectoryPage();
+  size_t num_results = result->size();
+  bool success = false;
+  for (uint32_t attempt = 0; attempt < OPTIMISTIC_READ_ATTEMPTS; attempt++) {
+    uint64_t version = raw_dir_page->GetVersion();
+    page_id_t bucket_page_id = KeyToPageId(key, dir_page);
+    if (!raw_dir_page->ValidateVersion(version)) {
+      continue;
+    }
+    auto [raw_page, bucket_page] = FetchBucketPage(bucket_page_id);
+    raw_page->RLatch();
+    success = bucket_page->GetValue(key, comparator_, result);
+    raw_page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+    // The key may have moved to another bucket if the bucket was split or merged before it was latched.
+    if (raw_dir_page->ValidateVersion(version)) {
+      buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+      num_lookups_.fetch_sub(1);
+      return success;
+    }
+    result->resize(num_results);
+  }
 
-  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
+  raw_dir_page->RLatch();
   page_id_t bucket_page_id = KeyToPageId(key, dir_page);
   auto [raw_page, bucket_page] = FetchBucketPage(bucket_page_id);
   raw_page->RLatch();
-  bool success = bucket_page->GetValue(key, comparator_, result);
+  raw_dir_page->RUnlatch();
+  success = bucket_page->GetValue(key, comparator_, result);
 
   buffer_pool_manager_->UnpinPage(directory_page_id_, false);
   buffer_pool_manager_->UnpinPage(bucket_page_id, false);
 
   raw_page->RUnlatch();
-  table_latch_.RUnlock();
+  num_lookups_.fetch_sub(1);
   return success;
 }
 
@@ -142,14 +175,15 @@ auto HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key,
   bool success = false;
   bool inserted = false;
   uint32_t i;
-  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
+  auto [raw_dir_page, dir_page] = FetchRawDirectoryPage();
+  raw_dir_page->WLatch();
 
   while (!inserted) {
     uint32_t global_depth = dir_page->GetGlobalDepth();
     uint32_t bucket_idx = KeyToDirectoryIndex(key, dir_page);
     uint32_t bucket_page_id = KeyToPageId(key, dir_page);
-    auto bucket_page = FetchBucketPage(bucket_page_id).second;
-    // raw_page->WLatch();
+    auto [raw_page, bucket_page] = FetchBucketPage(bucket_page_id);
+    raw_page->WLatch();
 
     if (bucket_page->IsFull()) {
       if (dir_page->GetLocalDepth(bucket_idx) == global_depth) {
@@ -175,8 +209,9 @@ auto HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key,
 
       uint32_t split_image_bucket_idx = dir_page->GetSplitImageIndex(bucket_idx);
       page_id_t split_image_bucket_page_id;
+      Page *split_image_raw_page = buffer_pool_manager_->NewPage(&split_image_bucket_page_id);
       HASH_TABLE_BUCKET_TYPE *split_image_bucket_page =
-          reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(buffer_pool_manager_->NewPage(&split_image_bucket_page_id));
+          reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(split_image_raw_page->GetData());
 
       uint32_t diff = 1 << dir_page->GetLocalDepth(bucket_idx);
       uint32_t dir_size = dir_page->Size();
@@ -218,17 +253,21 @@ auto HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key,
       }
 
       delete[] tmp_array;
+      raw_page->WUnlatch();
       buffer_pool_manager_->UnpinPage(bucket_page_id, true);
       buffer_pool_manager_->UnpinPage(split_image_bucket_page_id, true);
     } else {
       success = bucket_page->Insert(key, value, comparator_);
       inserted = true;
+      raw_page->WUnlatch();
       buffer_pool_manager_->UnpinPage(bucket_page_id, true);
     }
   }
 
+  raw_dir_page->WUnlatch();
   buffer_pool_manager_->UnpinPage(directory_page_id_, true);
 
+  DeleteRetiredBuckets();
   table_latch_.WUnlock();
   return success;
 }
@@ -263,7 +302,7 @@ void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const
   table_latch_.WLock();
   // LOG_INFO("# Merge key");
   uint32_t i;
-  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
+  auto [raw_dir_page, dir_page] = FetchRawDirectoryPage();
   uint32_t bucket_idx = KeyToDirectoryIndex(key, dir_page);
   if (dir_page->GetLocalDepth(bucket_idx) == 0) {
     buffer_pool_manager_->UnpinPage(directory_page_id_, false);
@@ -286,8 +325,9 @@ void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const
     return;
   }
 
+  // Lookups read the directory without the table latch; make them retry while the directory is rewired.
+  raw_dir_page->WLatch();
   buffer_pool_manager_->UnpinPage(bucket_page_id, false);
-  buffer_pool_manager_->DeletePage(bucket_page_id);
 
   page_id_t split_image_bucket_page_id = dir_page->GetBucketPageId(split_image_bucket_idx);
 
@@ -311,12 +351,32 @@ void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const
   while (dir_page->CanShrink()) {
     dir_page->DecrGlobalDepth();
   }
-
-  buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+  raw_dir_page->WUnlatch();
   buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+
+  // The directory no longer points at the bucket, but a lookup that read it before it was rewired may still be about
+  // to fetch the bucket. Deleting it now would let that fetch load a deallocated page, so it is deleted later.
+  retired_bucket_page_ids_.push_back(bucket_page_id);
+  DeleteRetiredBuckets();
   table_latch_.WUnlock();
 }
 
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::DeleteRetiredBuckets() {
+  // Lookups that start now read a directory that no longer points at any retired bucket. So once no lookup is in
+  // flight, none can reach them anymore.
+  if (num_lookups_.load() != 0) {
+    return;
+  }
+  std::vector<page_id_t> pinned_page_ids;
+  for (page_id_t page_id : retired_bucket_page_ids_) {
+    if (!buffer_pool_manager_->DeletePage(page_id)) {
+      pinned_page_ids.push_back(page_id);
+    }
+  }
+  retired_bucket_page_ids_ = std::move(pinned_page_ids);
+}
+
 /*****************************************************************************
  * GETGLOBALDEPTH - DO NOT TOUCH
  *****************************************************************************/
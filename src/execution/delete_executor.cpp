@@ -50,8 +50,8 @@ auto DeleteExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) -> bool {
   for (auto &index : catalog_->GetTableIndexes(table_info_->name_)) {
     auto key = tuple->KeyFromTuple(table_info_->schema_, *index->index_->GetKeySchema(), index->index_->GetKeyAttrs());
     index->index_->DeleteEntry(key, *rid, exec_ctx_->GetTransaction());
-    txn->GetIndexWriteSet()->emplace_back(
-        IndexWriteRecord(*rid, table_info_->oid_, WType::DELETE, *tuple, index->index_oid_, exec_ctx_->GetCatalog()));
+    txn->GetIndexWriteSet()->emplace_back(IndexWriteRecord(*rid, table_info_->oid_, WType::DELETE, *tuple, *tuple,
+                                                           index->index_oid_, exec_ctx_->GetCatalog()));
   }
 
   if (txn->GetIsolationLevel() != IsolationLevel::REPEATABLE_READ) {
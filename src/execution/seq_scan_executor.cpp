@@ -19,9 +19,10 @@ SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNod
       plan_(plan),
       table_heap_(exec_ctx->GetCatalog()->GetTable(plan->GetTableOid())->table_.get()),
       schema_(&exec_ctx->GetCatalog()->GetTable(plan->GetTableOid())->schema_),
-      iter_(table_heap_->Begin(exec_ctx->GetTransaction())) {}
+      strategy_(std::make_unique<BufferAccessStrategy>()),
+      iter_(table_heap_->Begin(exec_ctx->GetTransaction(), strategy_.get())) {}
 
-void SeqScanExecutor::Init() { iter_ = table_heap_->Begin(exec_ctx_->GetTransaction()); }
+void SeqScanExecutor::Init() { iter_ = table_heap_->Begin(exec_ctx_->GetTransaction(), strategy_.get()); }
 
 auto SeqScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
   bool get_result = false;
@@ -0,0 +1,54 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_access_strategy.h
+//
+// Identification: src/include/buffer/buffer_access_strategy.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <deque>
+#include <unordered_map>
+#include <utility>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+class BufferPoolManagerInstance;
+
+/**
+ * BufferAccessStrategy lets a bulk read, such as a sequential scan, fetch pages through a small private ring of frames.
+ * Once the ring is full, a miss recycles the oldest frame of the ring instead of taking a victim from the shared pool,
+ * so the scan can only displace as many pages of the shared pool as the ring holds.
+ *
+ * A strategy belongs to a single scan and must not be shared between threads.
+ */
+class BufferAccessStrategy {
+ public:
+  /**
+   * Creates a new BufferAccessStrategy.
+   * @param ring_size the maximum number of frames the bulk read may occupy across all buffer pool instances
+   */
+  explicit BufferAccessStrategy(size_t ring_size = SCAN_RING_SIZE) : ring_size_(ring_size) {}
+
+  DISALLOW_COPY(BufferAccessStrategy);
+
+  /** @return the maximum number of frames the bulk read may occupy */
+  auto GetRingSize() const -> size_t { return ring_size_; }
+
+ private:
+  friend class BufferPoolManagerInstance;
+
+  size_t ring_size_;
+  /** For each buffer pool instance, the frames it lent to this ring and the page each was loaded with, oldest first. */
+  std::unordered_map<const BufferPoolManagerInstance *, std::deque<std::pair<frame_id_t, page_id_t>>> rings_;
+};
+
+}  // namespace bustub
@@ -14,8 +14,12 @@
 
 #include <list>
 #include <mutex>  // NOLINT
+#include <string>
 #include <unordered_map>
+#include <vector>
 
+#include "buffer/buffer_access_strategy.h"
+#include "buffer/buffer_pool_stats.h"
 #include "buffer/lru_replacer.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
@@ -45,6 +49,35 @@ class BufferPoolManager {
     return result;
   }
 
+  /**
+   * Fetch the requested page on behalf of a bulk read. Misses recycle the frames of the strategy's ring once it is
+   * full.
+   * @param page_id id of page to be fetched
+   * @param strategy the access strategy of the bulk read, nullptr to fetch through the shared pool
+   * @return the requested page
+   */
+  auto FetchPage(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * { return FetchPgImp(page_id, strategy); }
+
+  /**
+   * Fetch a batch of pages. Cached pages are pinned right away, and all the misses are read from disk as one batch
+   * instead of one after another.
+   * @param page_ids ids of the pages to fetch; a page may be listed more than once, and is then pinned once per entry
+   * @return the pinned pages, in the order of page_ids; nullptr for pages that did not fit because every frame is
+   * pinned
+   */
+  auto FetchPages(const std::vector<page_id_t> &page_ids) -> std::vector<Page *> { return FetchPgsImp(page_ids); }
+
+  /**
+   * Start reading the given pages into the buffer pool without pinning them, so that later fetches find them cached.
+   * This is only a hint: pages that are already cached are skipped, and prefetching stops early if every frame is
+   * pinned.
+   * @param page_ids ids of the pages that are about to be fetched
+   * @param strategy the access strategy of the bulk read the pages are prefetched for, may be nullptr
+   */
+  void PrefetchPages(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy = nullptr) {
+    PrefetchPgsImp(page_ids, strategy);
+  }
+
   /** Grading function. Do not modify! */
   auto UnpinPage(page_id_t page_id, bool is_dirty, bufferpool_callback_fn callback = nullptr) -> bool {
     GradingCallback(callback, CallbackType::BEFORE, page_id);
@@ -84,9 +117,68 @@ class BufferPoolManager {
     GradingCallback(callback, CallbackType::AFTER, INVALID_PAGE_ID);
   }
 
+  /**
+   * Grow or shrink the buffer pool while it is in use. Shrinking evicts free frames first, then clean pages, then
+   * dirty pages, which are written back; pinned pages are never evicted.
+   * @param pool_size the new number of frames
+   * @return false if too many pages are pinned to shrink the pool to the requested size, in which case it is shrunk as
+   * far as possible
+   */
+  auto Resize(size_t pool_size) -> bool { return ResizeImp(pool_size); }
+
+  /**
+   * Serve reads of table scans straight from a read-only mapping of the database files, for analytic sessions over a
+   * quiescent database. Mapped pages skip the frame copy and the replacer, but they are neither pinned nor latched, so
+   * the database must not be written while mapped reads are on. Turning them on flushes the buffer pool first.
+   * @param enabled true to map the database files, false to unmap them
+   * @return false if the database files could not be mapped
+   */
+  auto SetMappedReads(bool enabled) -> bool { return SetMappedReadsImp(enabled); }
+
+  /**
+   * @param page_id id of the page
+   * @return the page data in the read-only mapping, nullptr if mapped reads are off or the page is not mapped
+   */
+  auto GetMappedPage(page_id_t page_id) -> const char * { return GetMappedPgImp(page_id); }
+
+  /**
+   * Tell the kernel how a scan is about to read a run of mapped pages.
+   * @param page_id id of the first page
+   * @param num_pages the number of pages
+   * @param access how the pages are read
+   */
+  void AdviseMappedPages(page_id_t page_id, size_t num_pages, MappedAccess access) {
+    AdviseMappedPgsImp(page_id, num_pages, access);
+  }
+
   /** @return size of the buffer pool */
   virtual auto GetPoolSize() -> size_t = 0;
 
+  /** @return a snapshot of the statistics of the buffer pool */
+  virtual auto GetStats() -> BufferPoolStats = 0;
+
+  /** Reset the counters of the buffer pool statistics to zero; the gauges keep describing the frames. */
+  virtual void ResetStats() = 0;
+
+  /** @return the ids of the pages cached in the buffer pool, from the most to the least recently used */
+  virtual auto GetResidentPages() -> std::vector<page_id_t> = 0;
+
+  /**
+   * Save the ids of the cached pages to a residency file, so that a restarted buffer pool can warm up with
+   * LoadResidency instead of refilling one miss at a time. Only the page ids are saved; dirty pages are not flushed.
+   * @param file_name the residency file, replaced atomically
+   * @return false if the file could not be written
+   */
+  auto SaveResidency(const std::string &file_name) -> bool;
+
+  /**
+   * Start reading the pages listed in a residency file in the background. The most recently used pages that fit in
+   * the buffer pool are prefetched in page id order, so that the disk sees sequential reads.
+   * @param file_name the residency file written by SaveResidency
+   * @return the number of pages requested from the prefetcher, 0 if the file is missing or invalid
+   */
+  auto LoadResidency(const std::string &file_name) -> size_t;
+
  protected:
   /**
    * Grading function. Do not modify!
@@ -108,6 +200,56 @@ class BufferPoolManager {
    */
   virtual auto FetchPgImp(page_id_t page_id) -> Page * = 0;
 
+  /**
+   * Fetch the requested page from the buffer pool using the given access strategy.
+   * @param page_id id of page to be fetched
+   * @param strategy the access strategy of the caller, may be nullptr
+   * @return the requested page
+   */
+  virtual auto FetchPgImp(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * = 0;
+
+  /**
+   * Fetch a batch of pages from the buffer pool.
+   * @param page_ids ids of the pages to fetch
+   * @return the pinned pages, nullptr for pages that could not be fetched
+   */
+  virtual auto FetchPgsImp(const std::vector<page_id_t> &page_ids) -> std::vector<Page *> = 0;
+
+  /**
+   * Start reading the given pages into the buffer pool without pinning them.
+   * @param page_ids ids of the pages to prefetch
+   * @param strategy the access strategy of the caller, may be nullptr
+   */
+  virtual void PrefetchPgsImp(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy) = 0;
+
+  /**
+   * Grow or shrink the buffer pool.
+   * @param pool_size the new number of frames
+   * @return false if too many pages are pinned to shrink the pool to the requested size
+   */
+  virtual auto ResizeImp(size_t pool_size) -> bool = 0;
+
+  /**
+   * Map or unmap the database files for mapped reads.
+   * @param enabled true to map the database files, false to unmap them
+   * @return false if the database files could not be mapped
+   */
+  virtual auto SetMappedReadsImp(bool enabled) -> bool = 0;
+
+  /**
+   * @param page_id id of the page
+   * @return the page data in the read-only mapping, nullptr if it is not mapped
+   */
+  virtual auto GetMappedPgImp(page_id_t page_id) -> const char * = 0;
+
+  /**
+   * Pass the access pattern of a run of mapped pages on to the kernel.
+   * @param page_id id of the first page
+   * @param num_pages the number of pages
+   * @param access how the pages are read
+   */
+  virtual void AdviseMappedPgsImp(page_id_t page_id, size_t num_pages, MappedAccess access) = 0;
+
   /**
    * Unpin the target page from the buffer pool.
    * @param page_id id of page to be unpinned
@@ -12,12 +12,27 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
+#include <deque>
 #include <list>
 #include <mutex>  // NOLINT
+#include <shared_mutex>
+#include <thread>  // NOLINT
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_stats.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/compressed_page_cache.h"
+#include "buffer/lru_k_replacer.h"
 #include "buffer/lru_replacer.h"
+#include "common/striped_counter.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/page.h"
@@ -34,8 +49,10 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    * @param pool_size the size of the buffer pool
    * @param disk_manager the disk manager
    * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy used to pick victim frames
    */
-  BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr);
+  BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr,
+                            ReplacerType replacer_type = ReplacerType::LRU);
   /**
    * Creates a new BufferPoolManagerInstance.
    * @param pool_size the size of the buffer pool
@@ -43,21 +60,82 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    * @param instance_index index of this BPI in the parallel BPM
    * @param disk_manager the disk manager
    * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy used to pick victim frames
    */
   BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
-                            DiskManager *disk_manager, LogManager *log_manager = nullptr);
+                            DiskManager *disk_manager, LogManager *log_manager = nullptr,
+                            ReplacerType replacer_type = ReplacerType::LRU);
 
   /**
    * Destroys an existing BufferPoolManagerInstance.
    */
   ~BufferPoolManagerInstance() override;
 
-  /** @return size of the buffer pool */
+  /** @return size of the buffer pool, including frames adopted from and excluding frames donated to siblings */
   auto GetPoolSize() -> size_t override { return pool_size_; }
 
-  /** @return pointer to all the pages in the buffer pool */
+  /** @return pointer to all the pages the buffer pool was created with */
   auto GetPages() -> Page * { return pages_; }
 
+  /**
+   * Give up a frame so that a sibling instance can adopt it. A free frame is given up first; otherwise an unpinned
+   * page is evicted, as on a miss.
+   * @return the frame, or nullptr if every frame is pinned
+   */
+  auto DonateFrame() -> Page *;
+
+  /**
+   * Take over a frame donated by a sibling instance and add it to the free list.
+   * @param page the donated frame
+   */
+  void AdoptFrame(Page *page);
+
+  /**
+   * Put a compressed page cache between this instance and the disk. Evicted pages, clean or dirty, are compressed into
+   * it, and misses look there before reading from disk. Must be called before the buffer pool is used.
+   * @param capacity the memory budget of the compressed page cache, in bytes
+   */
+  void EnableCompressedCache(size_t capacity);
+
+  /**
+   * Pin every dirty page of this instance and mark it clean, so that a flush can write the pages back in one batch
+   * with those of other instances. Each page must be handed to UnpinFlushedPages once it has been written back.
+   * @return the pinned pages
+   */
+  auto PinDirtyPages() -> std::vector<Page *>;
+
+  /**
+   * Drop the pins taken by PinDirtyPages, then write back the dirty pages of the compressed page cache, if any.
+   * @param pages the pages returned by PinDirtyPages
+   */
+  void UnpinFlushedPages(const std::vector<Page *> &pages);
+
+  /** Finish the reads already queued by PrefetchPages and stop the prefetch thread, if it is running. */
+  void StopPrefetchThread();
+
+  /**
+   * Start a background writer thread that writes back dirty, unpinned pages ahead of eviction, so that misses rarely
+   * have to write back a dirty victim themselves. Each round is skipped unless fewer than `low_watermark` frames are
+   * free or clean and evictable; otherwise frames are visited in a clock sweep until the watermark is reached again.
+   * @param low_watermark the number of free or clean evictable frames the writer tries to maintain
+   * @param max_pages_per_round the most pages written back per round, which bounds the writer's I/O rate
+   * @param interval how long the writer sleeps between rounds
+   */
+  void RunBackgroundWriter(size_t low_watermark, size_t max_pages_per_round = BACKGROUND_WRITER_MAX_PAGES,
+                           std::chrono::milliseconds interval = background_writer_interval);
+
+  /** Stop and join the background writer thread, if it is running. */
+  void StopBackgroundWriter();
+
+  /** @return a snapshot of the statistics of this instance; the gauges are gathered by scanning the frames */
+  auto GetStats() -> BufferPoolStats override;
+
+  /** Reset the counters of this instance's statistics to zero. */
+  void ResetStats() override;
+
+  /** @return the ids of the cached pages: pinned pages first, then the others in reverse eviction order */
+  auto GetResidentPages() -> std::vector<page_id_t> override;
+
  protected:
   /**
    * Fetch the requested page from the buffer pool.
@@ -66,6 +144,58 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   auto FetchPgImp(page_id_t page_id) -> Page * override;
 
+  /**
+   * Fetch the requested page from the buffer pool using the given access strategy.
+   * @param page_id id of page to be fetched
+   * @param strategy the access strategy of the caller, may be nullptr
+   * @return the requested page
+   */
+  auto FetchPgImp(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * override;
+
+  /**
+   * Grow or shrink the buffer pool.
+   * @param pool_size the new number of frames
+   * @return false if too many pages are pinned to shrink the pool to the requested size
+   */
+  auto ResizeImp(size_t pool_size) -> bool override;
+
+  /**
+   * Map or unmap the database files for mapped reads, flushing the buffer pool before mapping them.
+   * @param enabled true to map the database files, false to unmap them
+   * @return false if the database files could not be mapped
+   */
+  auto SetMappedReadsImp(bool enabled) -> bool override;
+
+  /**
+   * @param page_id id of the page
+   * @return the page data in the read-only mapping, nullptr if it is not mapped
+   */
+  auto GetMappedPgImp(page_id_t page_id) -> const char * override { return disk_manager_->GetMappedPage(page_id); }
+
+  /**
+   * Pass the access pattern of a run of mapped pages on to the kernel.
+   * @param page_id id of the first page
+   * @param num_pages the number of pages
+   * @param access how the pages are read
+   */
+  void AdviseMappedPgsImp(page_id_t page_id, size_t num_pages, MappedAccess access) override {
+    disk_manager_->AdviseMappedPages(page_id, num_pages, access);
+  }
+
+  /**
+   * Fetch a batch of pages from the buffer pool.
+   * @param page_ids ids of the pages to fetch
+   * @return the pinned pages, nullptr for pages that could not be fetched
+   */
+  auto FetchPgsImp(const std::vector<page_id_t> &page_ids) -> std::vector<Page *> override;
+
+  /**
+   * Start reading the given pages into the buffer pool without pinning them.
+   * @param page_ids ids of the pages to prefetch
+   * @param strategy the access strategy of the caller, may be nullptr
+   */
+  void PrefetchPgsImp(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy) override;
+
   /**
    * Unpin the target page from the buffer pool.
    * @param page_id id of page to be unpinned
@@ -96,24 +226,166 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   auto DeletePgImp(page_id_t page_id) -> bool override;
 
   /**
-   * Flushes all the pages in the buffer pool to disk.
+   * Flushes all the dirty pages in the buffer pool to disk, in page id order and in runs of consecutive pages.
    */
   void FlushAllPgsImp() override;
 
   /**
-   * Allocate a page on disk.∂
+   * Allocate a page on disk. Pages deallocated on disk are reused first, a whole extent of them being claimed from the
+   * disk manager at a time; the file only grows when there are none left for this instance.
    * @return the id of the allocated page
    */
   auto AllocatePage() -> page_id_t;
 
   /**
-   * Deallocate a page on disk.
+   * Deallocate a page on disk, so that its id can be allocated again.
    * @param page_id id of the page to deallocate
    */
-  void DeallocatePage(__attribute__((unused)) page_id_t page_id) {
-    // This is a no-nop right now without a more complex data structure to track deallocated pages
+  void DeallocatePage(page_id_t page_id) { disk_manager_->DeallocatePage(page_id); }
+
+  /**
+   * A partition of the page table. Each shard has its own latch so that lookups for pages in different shards never
+   * contend, and hits only take the shard latch in shared mode.
+   */
+  struct PageTableShard {
+    /** Shared for lookups, pinning and unpinning; exclusive for inserting or removing mappings. */
+    std::shared_mutex latch_;
+    /** Signalled whenever a page in this shard finishes loading from disk. */
+    std::condition_variable_any loaded_cv_;
+    /** Page id to frame id mapping for the pages that hash to this shard. */
+    std::unordered_map<page_id_t, frame_id_t> page_table_;
+  };
+
+  /**
+   * @param frame_id a frame id below num_frame_ids_
+   * @return the slot holding the frame with the given id, nullptr if the id has no frame
+   */
+  auto GetFrame(frame_id_t frame_id) -> std::atomic<Page *> & {
+    // Segment i holds frame_segment_size_ * 2^i frame ids, following the frame_segment_size_ * (2^i - 1) before it.
+    const size_t segment = 63 - __builtin_clzll(frame_id / frame_segment_size_ + 1);
+    return frame_segments_[segment][frame_id - frame_segment_size_ * ((size_t{1} << segment) - 1)];
+  }
+
+  /** Add the next segment of frame ids to the empty frame ids. Must be called while holding latch_. */
+  void AddFrameSegment();
+
+  /** @return the page table shard responsible for the given page id */
+  auto GetShard(page_id_t page_id) -> PageTableShard & {
+    return page_table_[(page_id / num_instances_) % NUM_PAGE_TABLE_SHARDS];
   }
 
+  /**
+   * Pin a frame that was found in the page table, waiting for it to finish loading if a concurrent miss is still
+   * reading it in. The caller must hold the shard latch (in any mode) through `lock`.
+   * @param shard the shard the page was found in
+   * @param lock the lock held on the shard latch
+   * @param frame_id the frame holding the page
+   * @return the pinned page, or nullptr if the miss failed to read it
+   */
+  template <typename Lock>
+  auto PinFrame(PageTableShard *shard, Lock *lock, frame_id_t frame_id) -> Page *;
+
+  /**
+   * Pin a frame that was found in the page table without waiting for it to finish loading. The caller must hold the
+   * shard latch (in any mode).
+   * @param frame_id the frame holding the page
+   * @return the pinned page, which may still be loading
+   */
+  auto PinResidentFrame(frame_id_t frame_id) -> Page *;
+
+  /**
+   * Obtain a frame that is not referenced by the page table, the free list or the replacer. A full ring of the access
+   * strategy is recycled first; otherwise frames are taken from the free list first, then from the replacer.
+   * Must be called without holding any shard latch.
+   * @param[out] frame_id the acquired frame
+   * @param strategy the access strategy of the caller, may be nullptr
+   * @return false if every frame is pinned
+   */
+  auto AcquireFrame(frame_id_t *frame_id, BufferAccessStrategy *strategy = nullptr) -> bool;
+
+  /**
+   * Try to recycle the oldest frame of the strategy's ring. Ring entries whose frame was pinned or reused by someone
+   * else in the meantime are dropped from the ring.
+   * @param strategy the access strategy of the caller
+   * @param[out] frame_id the recycled frame
+   * @return true if a frame was recycled and is now owned by the caller
+   */
+  auto RecycleRingFrame(BufferAccessStrategy *strategy, frame_id_t *frame_id) -> bool;
+
+  /**
+   * Try to detach a victim frame from the page it holds, writing the page back if it is dirty.
+   * The replacer may hand out frames that were pinned or remapped after it chose them, so the frame is re-validated
+   * under the shard latch before it is evicted.
+   * @param frame_id the candidate victim
+   * @param expected_page_id if valid, only evict the frame if it still holds this page
+   * @return true if the frame was evicted and is now owned by the caller
+   */
+  auto EvictFrame(frame_id_t frame_id, page_id_t expected_page_id = INVALID_PAGE_ID) -> bool;
+
+  /** Return a frame owned by the caller to the free list. */
+  void ReleaseFrame(frame_id_t frame_id);
+
+  /**
+   * Move a page from the compressed page cache into a frame that is loading it.
+   * @param page_id id of the page
+   * @param p_page the frame, which is dirty afterwards if the cached page was
+   * @return false if the compressed page cache is disabled or does not hold the page
+   */
+  auto TakeFromCompressedCache(page_id_t page_id, Page *p_page) -> bool;
+
+  /**
+   * Read a page into a frame that is loading it, from the compressed page cache if possible, else from disk.
+   * @return false if the page could not be read from disk
+   */
+  auto ReadPageIn(page_id_t page_id, Page *p_page) -> bool;
+
+  /**
+   * Finish loading a page into a frame and wake the fetches waiting for it. A page that could not be read is dropped
+   * from the page table together with the loader's pin, so that the waiting fetches fail as well.
+   * @param frame_id the frame the page was loaded into
+   * @param page_id id of the page
+   * @param loaded false if the page could not be read
+   */
+  void FinishLoading(frame_id_t frame_id, page_id_t page_id, bool loaded);
+
+  /**
+   * Drop a pin on a frame whose page failed to load, returning the frame to the free list once it is unpinned.
+   * The caller must hold the latch of the shard the page was in.
+   */
+  void UnpinFailedFrame(frame_id_t frame_id);
+
+  /**
+   * Lock a latch through a deferred lock, counting the time spent blocked on it when it is contended. The uncontended
+   * path only costs a try_lock.
+   * @param lock a std::unique_lock or std::shared_lock that does not own its latch yet
+   */
+  template <typename Lock>
+  void LockTimed(Lock *lock);
+
+  /**
+   * Run one round of the background writer.
+   * @param low_watermark the number of free or clean evictable frames to maintain
+   * @param max_pages_per_round the most pages to write back in this round
+   */
+  void BackgroundWriterRound(size_t low_watermark, size_t max_pages_per_round);
+
+  /**
+   * Write back a frame if it holds a dirty, unpinned page. The page is pinned and read latched while it is written, but
+   * its position in the replacer is left alone.
+   * @param frame_id the frame to clean
+   * @return true if the page was written back
+   */
+  auto CleanFrame(frame_id_t frame_id) -> bool;
+
+  /** Body of the prefetch thread: complete queued reads until the instance is destroyed and the queue is drained. */
+  void PrefetchLoop();
+
+  /**
+   * Read prefetched pages into the frames reserved for them, then drop the pins held on them while they were loading.
+   * @param prefetches the reserved frames and the page each is loading
+   */
+  void CompletePrefetches(const std::vector<std::pair<frame_id_t, page_id_t>> &prefetches);
+
   /**
    * Validate that the page_id being used is accessible to this BPI. This can be used in all of the functions to
    * validate input data and ensure that a parallel BPM is routing requests to the correct BPI
@@ -121,28 +393,109 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   void ValidatePageId(page_id_t page_id) const;
 
-  /** Number of pages in the buffer pool. */
-  const size_t pool_size_;
+  /** Number of partitions of the page table. */
+  static constexpr size_t NUM_PAGE_TABLE_SHARDS = 16;
+
+  /** Number of segments of frame ids; they double in size, so this bounds the pool at 2^32 times its initial size. */
+  static constexpr size_t NUM_FRAME_SEGMENTS = 32;
+
+  /** Number of frames in the buffer pool. */
+  std::atomic<size_t> pool_size_;
+  /** Number of frame ids in the first segment, enough for all the frames of a parallel BPM. */
+  const size_t frame_segment_size_;
+  /** Number of frame ids in the allocated segments. */
+  std::atomic<size_t> num_frame_ids_ = 0;
   /** How many instances are in the parallel BPM (if present, otherwise just 1 BPI) */
   const uint32_t num_instances_ = 1;
   /** Index of this BPI in the parallel BPM (if present, otherwise just 0) */
   const uint32_t instance_index_ = 0;
   /** Each BPI maintains its own counter for page_ids to hand out, must ensure they mod back to its instance_index_ */
   std::atomic<page_id_t> next_page_id_ = instance_index_;
+  /**
+   * Deallocated pages claimed from the disk manager but not allocated yet, highest page id first. Pages still here when
+   * the instance is destroyed stay claimed, i.e. they leak until the database is rebuilt.
+   */
+  std::vector<page_id_t> free_page_ids_;
+  /** Protects free_page_ids_. */
+  std::mutex free_page_ids_latch_;
 
-  /** Array of buffer pool pages. */
+  /** Array of the buffer pool pages the instance was created with, some may have been donated to siblings. */
   Page *pages_;
+  /** Number of pages in pages_. */
+  size_t num_arena_frames_;
+  /**
+   * The data of pages_, one page after the other in a single page-aligned mapping so that frames can be handed to the
+   * kernel for direct I/O. Backed by huge pages where the OS provides them.
+   */
+  char *frame_arena_;
+  size_t frame_arena_size_;
   /** Pointer to the disk manager. */
   DiskManager *disk_manager_ __attribute__((__unused__));
   /** Pointer to the log manager. */
   LogManager *log_manager_ __attribute__((__unused__));
-  /** Page table for keeping track of buffer pool pages. */
-  std::unordered_map<page_id_t, frame_id_t> page_table_;
+  /** Page table for keeping track of buffer pool pages, partitioned by page id. */
+  std::vector<PageTableShard> page_table_;
   /** Replacer to find unpinned pages for replacement. */
   Replacer *replacer_;
+  /** Second cache tier for evicted pages, nullptr if disabled. */
+  CompressedPageCache *compressed_cache_ = nullptr;
   /** List of free pages. */
   std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
+  /**
+   * The frame held under each frame id, nullptr for ids without a frame, in segments that are never moved or freed
+   * while the instance lives. An id is only remapped while its frame is owned by a single thread, i.e. it is neither in
+   * the page table, the free list nor the replacer.
+   */
+  std::array<std::atomic<Page *> *, NUM_FRAME_SEGMENTS> frame_segments_{};
+  /** Frame ids without a frame, available to frames adopted from siblings or added by a resize. */
+  std::vector<frame_id_t> empty_frame_ids_;
+  /**
+   * This latch protects the free list and the empty frame ids. The page table is protected by the per-shard latches.
+   */
   std::mutex latch_;
+
+  /** Serializes resizes. Also protects allocated_pages_ and retired_pages_. */
+  std::mutex resize_mutex_;
+  /**
+   * Held exclusively while a shrink frees the frames it claimed, and shared by everyone who may look at a frame they
+   * have not pinned or otherwise claimed.
+   */
+  std::shared_mutex resize_latch_;
+  /** Frames allocated one at a time by resizes, which a shrink can free. */
+  std::unordered_set<Page *> allocated_pages_;
+  /** Frames taken out by a shrink that belong to an array allocated at construction, reused first when growing. */
+  std::vector<Page *> retired_pages_;
+
+  /** The background writer thread, nullptr if it is not running. */
+  std::thread *background_writer_ = nullptr;
+  /** Protects background_writer_running_. */
+  std::mutex background_writer_latch_;
+  /** Wakes the background writer up when it has to stop. */
+  std::condition_variable background_writer_cv_;
+  bool background_writer_running_ = false;
+  /** Next frame the background writer's clock sweep visits. */
+  size_t background_writer_cursor_ = 0;
+
+  /** The thread that reads prefetched pages, started by the first prefetch. */
+  std::thread *prefetch_thread_ = nullptr;
+  /** Protects the prefetch queue and prefetch_running_. */
+  std::mutex prefetch_latch_;
+  /** Wakes the prefetch thread up when reads are queued or it has to stop. */
+  std::condition_variable prefetch_cv_;
+  bool prefetch_running_ = false;
+  /** Frames reserved for prefetched pages and the page each is loading, oldest first. */
+  std::deque<std::pair<frame_id_t, page_id_t>> prefetch_queue_;
+
+  /** Statistics counters, see BufferPoolStats. They are striped so that counting never contends across threads. */
+  StripedCounter num_hits_;
+  StripedCounter num_misses_;
+  StripedCounter num_new_pages_;
+  StripedCounter num_prefetches_;
+  StripedCounter num_evictions_;
+  StripedCounter num_foreground_writebacks_;
+  StripedCounter num_background_writebacks_;
+  StripedCounter num_flushes_;
+  StripedCounter num_latch_waits_;
+  StripedCounter latch_wait_ns_;
 };
 }  // namespace bustub
@@ -0,0 +1,128 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats.h
+//
+// Identification: src/include/buffer/buffer_pool_stats.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <sstream>
+#include <string>
+
+namespace bustub {
+
+/**
+ * BufferPoolStats is a snapshot of the statistics of a buffer pool. The counters cover the time since the pool was
+ * created or its statistics were last reset; the gauges describe the frames at the time of the snapshot.
+ */
+struct BufferPoolStats {
+  /** Pin counts are bucketed by powers of two: 0, 1, 2-3, 4-7 and 8 or more. */
+  static constexpr size_t NUM_PIN_COUNT_BUCKETS = 5;
+
+  /** Fetches that found the page in the buffer pool. */
+  size_t num_hits_ = 0;
+  /** Fetches that had to read the page from disk. */
+  size_t num_misses_ = 0;
+  /** Pages created with NewPage. */
+  size_t num_new_pages_ = 0;
+  /** Pages read ahead by PrefetchPages. */
+  size_t num_prefetches_ = 0;
+  /** Pages evicted to make room for others, including those evicted by shrinking or lending frames. */
+  size_t num_evictions_ = 0;
+  /** Dirty pages written back by the thread that evicted them. */
+  size_t num_foreground_writebacks_ = 0;
+  /** Dirty pages written back by the background writer. */
+  size_t num_background_writebacks_ = 0;
+  /** Pages written by FlushPage and FlushAllPages. */
+  size_t num_flushes_ = 0;
+  /** Times a thread had to block on the free list latch or a page table latch. */
+  size_t num_latch_waits_ = 0;
+  /** Total time spent blocked on those latches, in nanoseconds. */
+  size_t latch_wait_ns_ = 0;
+  /** Misses served by the compressed page cache instead of the disk. */
+  size_t num_compressed_hits_ = 0;
+  /** Misses that were not in the compressed page cache either. */
+  size_t num_compressed_misses_ = 0;
+
+  /** Number of frames in the pool. */
+  size_t pool_size_ = 0;
+  /** Number of frames on the free list. */
+  size_t num_free_frames_ = 0;
+  /** Number of frames holding a dirty page. */
+  size_t num_dirty_frames_ = 0;
+  /** Bytes of page data held by the compressed page cache. */
+  size_t compressed_bytes_ = 0;
+  /** Number of pages held by the compressed page cache. */
+  size_t num_compressed_pages_ = 0;
+  /** Number of frames holding a page, by pin count bucket. */
+  std::array<size_t, NUM_PIN_COUNT_BUCKETS> pin_count_histogram_{};
+
+  /** @return the bucket of pin_count_histogram_ that counts frames with the given pin count */
+  static auto PinCountBucket(int pin_count) -> size_t {
+    size_t bucket = 0;
+    while (pin_count > 0 && bucket + 1 < NUM_PIN_COUNT_BUCKETS) {
+      pin_count >>= 1;
+      bucket++;
+    }
+    return bucket;
+  }
+
+  /** @return the fraction of fetches that were hits, 0 if there were none */
+  auto HitRatio() const -> double {
+    size_t num_fetches = num_hits_ + num_misses_;
+    return num_fetches == 0 ? 0 : static_cast<double>(num_hits_) / static_cast<double>(num_fetches);
+  }
+
+  /** Add the statistics of another buffer pool, e.g. to aggregate the instances of a parallel buffer pool. */
+  auto operator+=(const BufferPoolStats &other) -> BufferPoolStats & {
+    num_hits_ += other.num_hits_;
+    num_misses_ += other.num_misses_;
+    num_new_pages_ += other.num_new_pages_;
+    num_prefetches_ += other.num_prefetches_;
+    num_evictions_ += other.num_evictions_;
+    num_foreground_writebacks_ += other.num_foreground_writebacks_;
+    num_background_writebacks_ += other.num_background_writebacks_;
+    num_flushes_ += other.num_flushes_;
+    num_latch_waits_ += other.num_latch_waits_;
+    latch_wait_ns_ += other.latch_wait_ns_;
+    num_compressed_hits_ += other.num_compressed_hits_;
+    num_compressed_misses_ += other.num_compressed_misses_;
+    compressed_bytes_ += other.compressed_bytes_;
+    num_compressed_pages_ += other.num_compressed_pages_;
+    pool_size_ += other.pool_size_;
+    num_free_frames_ += other.num_free_frames_;
+    num_dirty_frames_ += other.num_dirty_frames_;
+    for (size_t i = 0; i < NUM_PIN_COUNT_BUCKETS; i++) {
+      pin_count_histogram_[i] += other.pin_count_histogram_[i];
+    }
+    return *this;
+  }
+
+  /** @return a one-line, human readable summary */
+  auto ToString() const -> std::string {
+    std::ostringstream os;
+    os << "hits=" << num_hits_ << " misses=" << num_misses_ << " hit_ratio=" << HitRatio()
+       << " new_pages=" << num_new_pages_ << " prefetches=" << num_prefetches_ << " evictions=" << num_evictions_
+       << " foreground_writebacks=" << num_foreground_writebacks_
+       << " background_writebacks=" << num_background_writebacks_ << " flushes=" << num_flushes_
+       << " latch_waits=" << num_latch_waits_ << " latch_wait_ns=" << latch_wait_ns_
+       << " compressed_hits=" << num_compressed_hits_ << " compressed_misses=" << num_compressed_misses_
+       << " compressed_pages=" << num_compressed_pages_ << " compressed_bytes=" << compressed_bytes_
+       << " pool_size=" << pool_size_ << " free=" << num_free_frames_ << " dirty=" << num_dirty_frames_
+       << " pins[0,1,2-3,4-7,8+]=";
+    for (size_t i = 0; i < NUM_PIN_COUNT_BUCKETS; i++) {
+      os << (i == 0 ? "" : ",") << pin_count_histogram_[i];
+    }
+    return os.str();
+  }
+};
+
+}  // namespace bustub
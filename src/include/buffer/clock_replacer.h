@@ -12,8 +12,9 @@
 
 #pragma once
 
-#include <list>
-#include <mutex>  // NOLINT
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <vector>
 
 #include "buffer/replacer.h"
@@ -23,6 +24,11 @@ namespace bustub {
 
 /**
  * ClockReplacer implements the clock replacement policy, which approximates the Least Recently Used policy.
+ *
+ * The state of every frame lives in a flat array of atomic bytes, so Pin, Unpin and RecordAccess are a single atomic
+ * read-modify-write and never block. Only Victim sweeps: the clock hand clears the reference bit of each evictable
+ * frame it passes and takes the first evictable frame whose reference bit is already clear. Concurrent sweeps share
+ * the hand.
  */
 class ClockReplacer : public Replacer {
  public:
@@ -43,10 +49,36 @@ class ClockReplacer : public Replacer {
 
   void Unpin(frame_id_t frame_id) override;
 
+  void RecordAccess(frame_id_t frame_id) override;
+
+  void SetCapacity(size_t num_pages) override;
+
+  auto GetEvictionOrder() -> std::vector<frame_id_t> override;
+
   auto Size() -> size_t override;
 
  private:
-  // TODO(student): implement me!
+  /** The frame is unpinned and may be victimized. */
+  static constexpr uint8_t EVICTABLE = 1;
+  /** The frame was referenced since the clock hand last passed it. */
+  static constexpr uint8_t REFERENCED = 2;
+
+  /** Number of segments of frame states; they double in size, like the frame ids of a buffer pool. */
+  static constexpr size_t NUM_SEGMENTS = 32;
+
+  /** @return the state of the given frame, which must be below the capacity */
+  auto GetState(frame_id_t frame_id) -> std::atomic<uint8_t> &;
+
+  /** Number of frame states in the first segment. */
+  const size_t segment_size_;
+  /** Frame states, in segments that are never moved or freed, so growing never blocks the other operations. */
+  std::array<std::atomic<uint8_t> *, NUM_SEGMENTS> segments_{};
+  /** Number of frame states in the allocated segments. */
+  std::atomic<size_t> capacity_ = 0;
+  /** Number of evictable frames. */
+  std::atomic<size_t> size_ = 0;
+  /** Position of the clock hand, taken modulo the capacity. */
+  std::atomic<size_t> hand_ = 0;
 };
 
 }  // namespace bustub
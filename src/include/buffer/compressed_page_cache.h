@@ -0,0 +1,145 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_cache.h
+//
+// Identification: src/include/buffer/compressed_page_cache.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+
+#include "common/config.h"
+#include "common/macros.h"
+#include "common/striped_counter.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * CompressedPageCache is a second cache tier between a buffer pool and the disk. Pages evicted from the buffer pool are
+ * compressed into a memory budget instead of being dropped, and misses look here before reading from disk. A page is
+ * never held by both tiers at once: a hit moves the page back into the buffer pool.
+ *
+ * Dirty pages stay dirty while compressed. They are only written to disk when the cache itself evicts them, in least
+ * recently inserted order, or when it is flushed.
+ */
+class CompressedPageCache {
+ public:
+  /**
+   * Creates a new CompressedPageCache.
+   * @param capacity the memory budget for compressed pages, in bytes
+   * @param disk_manager the disk manager that dirty pages are written back to
+   */
+  CompressedPageCache(size_t capacity, DiskManager *disk_manager);
+
+  DISALLOW_COPY(CompressedPageCache);
+
+  /**
+   * Compress a page into the cache, replacing any older copy. Pages that do not fit into the budget even once
+   * everything else is evicted are written back right away if they are dirty.
+   * @param page_id id of the page
+   * @param page_data raw page data
+   * @param is_dirty true if the page has not been written back since it was last modified
+   */
+  void Insert(page_id_t page_id, const char *page_data, bool is_dirty);
+
+  /**
+   * Take a page out of the cache.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer
+   * @param[out] is_dirty whether the page still has to be written back
+   * @return false if the page is not cached
+   */
+  auto Take(page_id_t page_id, char *page_data, bool *is_dirty) -> bool;
+
+  /** Drop a page from the cache without writing it back, e.g. because it was deleted. */
+  void Erase(page_id_t page_id);
+
+  /**
+   * Write back a page if it is cached and dirty; the page stays cached.
+   * @param page_id id of the page
+   * @return false if the page is not cached
+   */
+  auto Flush(page_id_t page_id) -> bool;
+
+  /** Write back every dirty page in the cache; the pages stay cached. */
+  void FlushAll();
+
+  /** @return the number of bytes of compressed page data currently held */
+  auto GetSize() -> size_t;
+
+  /** @return the number of pages currently held */
+  auto GetNumPages() -> size_t;
+
+  /** @return the number of Take calls that found their page */
+  auto GetNumHits() const -> size_t { return num_hits_.Load(); }
+
+  /** @return the number of Take calls that did not find their page */
+  auto GetNumMisses() const -> size_t { return num_misses_.Load(); }
+
+  /** Reset the hit and miss counters to zero. */
+  void ResetStats() {
+    num_hits_.Reset();
+    num_misses_.Reset();
+  }
+
+  /**
+   * Compress a buffer with a byte-oriented LZ77 codec. The output is a sequence of literal runs and back references
+   * into the last 64 KiB of output, each introduced by a one-byte token.
+   * @param data the buffer to compress
+   * @param size its size
+   * @param[out] compressed the compressed buffer
+   */
+  static void Compress(const char *data, size_t size, std::string *compressed);
+
+  /**
+   * Decompress a buffer produced by Compress.
+   * @param compressed the compressed buffer
+   * @param[out] data output buffer
+   * @param size the size of the original buffer
+   * @return false if the compressed buffer is malformed or does not decompress to exactly `size` bytes
+   */
+  static auto Decompress(const std::string &compressed, char *data, size_t size) -> bool;
+
+ private:
+  struct Entry {
+    /** The compressed page, or the raw page if it does not compress. */
+    std::string data_;
+    bool is_compressed_;
+    bool is_dirty_;
+    /** Position in lru_. */
+    std::list<page_id_t>::iterator lru_iter_;
+  };
+
+  /** Restore the page held by an entry. */
+  static void Restore(const Entry &entry, char *page_data);
+
+  /** Remove an entry, writing it back if it is dirty. Must be called while holding latch_. */
+  void Evict(std::unordered_map<page_id_t, Entry>::iterator iter);
+
+  /**
+   * Protects everything below. Dirty pages are written back while it is held, so a concurrent miss can never read a
+   * page from disk before its last version got there.
+   */
+  std::mutex latch_;
+  const size_t capacity_;
+  size_t size_ = 0;
+  DiskManager *disk_manager_;
+  std::unordered_map<page_id_t, Entry> entries_;
+  /** Cached page ids, most recently inserted first. */
+  std::list<page_id_t> lru_;
+
+  StripedCounter num_hits_;
+  StripedCounter num_misses_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,98 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.h
+//
+// Identification: src/include/buffer/lru_k_replacer.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <deque>
+#include <mutex>  // NOLINT
+#include <set>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * LRUKReplacer implements the LRU-K replacement policy.
+ *
+ * The victim is the evictable frame whose backward K-distance is largest, where the backward K-distance is the
+ * difference between the current logical time and the time of the K-th most recent reference. Frames with fewer than
+ * K references have an infinite backward K-distance; ties among them are broken by classic LRU on their most recent
+ * reference. A one-off scan therefore only displaces other pages that have been referenced fewer than K times.
+ *
+ * References that fall within the correlated reference period of the previous reference are collapsed into it, and a
+ * frame is not eligible for eviction until its correlated reference period has passed.
+ */
+class LRUKReplacer : public Replacer {
+ public:
+  /**
+   * Create a new LRUKReplacer.
+   * @param num_pages the maximum number of pages the LRUKReplacer will be required to store
+   * @param k the number of references to look back
+   * @param correlated_reference_period number of logical ticks during which repeated references count as one
+   */
+  explicit LRUKReplacer(size_t num_pages, size_t k = LRUK_REPLACER_K,
+                        size_t correlated_reference_period = LRUK_CORRELATED_REFERENCE_PERIOD);
+
+  /**
+   * Destroys the LRUKReplacer.
+   */
+  ~LRUKReplacer() override;
+
+  auto Victim(frame_id_t *frame_id) -> bool override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  void SetCapacity(size_t num_pages) override;
+
+  auto GetEvictionOrder() -> std::vector<frame_id_t> override;
+
+  void RecordAccess(frame_id_t frame_id) override;
+
+  auto Size() -> size_t override;
+
+ private:
+  /** Eviction order key: (has K references, time of K-th or most recent reference, frame id). */
+  using EvictionKey = std::tuple<bool, size_t, frame_id_t>;
+
+  struct FrameHistory {
+    /** Reference timestamps, most recent first, at most k_ of them. */
+    std::deque<size_t> history_;
+    /** Timestamp of the last reference, including correlated ones. */
+    size_t last_access_ = 0;
+    bool evictable_ = false;
+  };
+
+  /** Record a reference to the frame at the current logical time. */
+  void Access(frame_id_t frame_id, FrameHistory *frame);
+
+  auto KeyOf(frame_id_t frame_id, const FrameHistory &frame) const -> EvictionKey;
+
+  std::mutex mutex_;
+  size_t num_pages_;
+  size_t k_;
+  size_t correlated_reference_period_;
+  /** Logical clock, advanced on every reference. */
+  size_t current_timestamp_ = 0;
+  std::unordered_map<frame_id_t, FrameHistory> frames_;
+  /** Evictable frames in eviction order. */
+  std::set<EvictionKey> evictable_;
+};
+
+}  // namespace bustub
@@ -45,6 +45,10 @@ class LRUReplacer : public Replacer {
 
   void Unpin(frame_id_t frame_id) override;
 
+  void SetCapacity(size_t num_pages) override;
+
+  auto GetEvictionOrder() -> std::vector<frame_id_t> override;
+
   auto Size() -> size_t override;
 
  private:
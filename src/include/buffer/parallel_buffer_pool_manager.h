@@ -29,9 +29,10 @@ class ParallelBufferPoolManager : public BufferPoolManager {
    * @param pool_size the pool size of each BufferPoolManagerInstance
    * @param disk_manager the disk manager
    * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy of every BufferPoolManagerInstance
    */
   ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
-                            LogManager *log_manager = nullptr);
+                            LogManager *log_manager = nullptr, ReplacerType replacer_type = ReplacerType::LRU);
 
   /**
    * Destroys an existing ParallelBufferPoolManager.
@@ -41,6 +42,35 @@ class ParallelBufferPoolManager : public BufferPoolManager {
   /** @return size of the buffer pool */
   auto GetPoolSize() -> size_t override;
 
+  /** @return the statistics of all BufferPoolManagerInstances added together */
+  auto GetStats() -> BufferPoolStats override;
+
+  /** Reset the statistics counters of every BufferPoolManagerInstance. */
+  void ResetStats() override;
+
+  /**
+   * @return the ids of the pages cached by all BufferPoolManagerInstances; the instances' lists are interleaved, so any
+   * prefix holds the hottest pages of every instance
+   */
+  auto GetResidentPages() -> std::vector<page_id_t> override;
+
+  /**
+   * Put a compressed page cache in front of the disk for every BufferPoolManagerInstance. Must be called before the
+   * buffer pool is used.
+   * @param capacity the total memory budget, split evenly between the instances, in bytes
+   */
+  void EnableCompressedCache(size_t capacity);
+
+  /**
+   * Start the background writer of every BufferPoolManagerInstance.
+   * @param low_watermark the number of free or clean evictable frames each instance tries to maintain
+   * @param max_pages_per_round the most pages each instance writes back per round
+   */
+  void RunBackgroundWriters(size_t low_watermark, size_t max_pages_per_round = BACKGROUND_WRITER_MAX_PAGES);
+
+  /** Stop the background writer of every BufferPoolManagerInstance. */
+  void StopBackgroundWriters();
+
  protected:
   /**
    * @param page_id id of page
@@ -55,6 +85,58 @@ class ParallelBufferPoolManager : public BufferPoolManager {
    */
   auto FetchPgImp(page_id_t page_id) -> Page * override;
 
+  /**
+   * Fetch the requested page from the buffer pool using the given access strategy.
+   * @param page_id id of page to be fetched
+   * @param strategy the access strategy of the caller, may be nullptr
+   * @return the requested page
+   */
+  auto FetchPgImp(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * override;
+
+  /**
+   * Grow or shrink the buffer pool, spreading the frames evenly over the instances.
+   * @param pool_size the new total number of frames
+   * @return false if too many pages are pinned to shrink the pool to the requested size
+   */
+  auto ResizeImp(size_t pool_size) -> bool override;
+
+  /**
+   * Map or unmap the database files for mapped reads, flushing the buffer pool before mapping them.
+   * @param enabled true to map the database files, false to unmap them
+   * @return false if the database files could not be mapped
+   */
+  auto SetMappedReadsImp(bool enabled) -> bool override;
+
+  /**
+   * @param page_id id of the page
+   * @return the page data in the read-only mapping, nullptr if it is not mapped
+   */
+  auto GetMappedPgImp(page_id_t page_id) -> const char * override { return disk_manager_->GetMappedPage(page_id); }
+
+  /**
+   * Pass the access pattern of a run of mapped pages on to the kernel.
+   * @param page_id id of the first page
+   * @param num_pages the number of pages
+   * @param access how the pages are read
+   */
+  void AdviseMappedPgsImp(page_id_t page_id, size_t num_pages, MappedAccess access) override {
+    disk_manager_->AdviseMappedPages(page_id, num_pages, access);
+  }
+
+  /**
+   * Fetch a batch of pages from the buffer pool.
+   * @param page_ids ids of the pages to fetch
+   * @return the pinned pages, nullptr for pages that could not be fetched
+   */
+  auto FetchPgsImp(const std::vector<page_id_t> &page_ids) -> std::vector<Page *> override;
+
+  /**
+   * Start reading the given pages into the buffer pool without pinning them.
+   * @param page_ids ids of the pages to prefetch
+   * @param strategy the access strategy of the caller, may be nullptr
+   */
+  void PrefetchPgsImp(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy) override;
+
   /**
    * Unpin the target page from the buffer pool.
    * @param page_id id of page to be unpinned
@@ -85,14 +167,15 @@ class ParallelBufferPoolManager : public BufferPoolManager {
   auto DeletePgImp(page_id_t page_id) -> bool override;
 
   /**
-   * Flushes all the pages in the buffer pool to disk.
+   * Flushes all the dirty pages in the buffer pool to disk. The dirty pages of all instances are sorted by page id and
+   * written in runs of consecutive pages, with one slice of the runs per instance written in parallel.
    */
   void FlushAllPgsImp() override;
 
  private:
-  size_t pool_size_;
   size_t num_instances_;
   std::vector<BufferPoolManagerInstance *> instances_;
+  DiskManager *disk_manager_;
   size_t start_index_ = 0;
   std::mutex latch_;
 };
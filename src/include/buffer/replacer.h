@@ -12,10 +12,15 @@
 
 #pragma once
 
+#include <vector>
+
 #include "common/config.h"
 
 namespace bustub {
 
+/** The replacement policies a buffer pool can be constructed with. */
+enum class ReplacerType { LRU, LRU_K, CLOCK };
+
 /**
  * Replacer is an abstract class that tracks page usage.
  */
@@ -25,7 +30,8 @@ class Replacer {
   virtual ~Replacer() = default;
 
   /**
-   * Remove the victim frame as defined by the replacement policy.
+   * Remove the victim frame as defined by the replacement policy. The frame is no longer evictable, but its history is
+   * kept: the caller may still fail to evict the page, and calls Remove once it has.
    * @param[out] frame_id id of frame that was removed, nullptr if no victim was found
    * @return true if a victim frame was found, false otherwise
    */
@@ -43,6 +49,32 @@ class Replacer {
    */
   virtual void Unpin(frame_id_t frame_id) = 0;
 
+  /**
+   * Forgets a frame whose page was evicted or deleted, so that the next page it holds starts without the old page's
+   * references.
+   * Policies that keep nothing beyond pin state only need to pin it.
+   * @param frame_id the id of the frame to remove
+   */
+  virtual void Remove(frame_id_t frame_id) { Pin(frame_id); }
+
+  /**
+   * Records that the page held by a frame was referenced. Policies that only need pin/unpin events can ignore this.
+   * @param frame_id the id of the frame that was accessed
+   */
+  virtual void RecordAccess(frame_id_t frame_id) {}
+
+  /**
+   * Changes the number of frames the replacer may be required to store, as the buffer pool grows.
+   * @param num_pages the new maximum number of frames
+   */
+  virtual void SetCapacity(size_t num_pages) {}
+
+  /**
+   * @return the frames that can be victimized, in the order they would be victimized. Policies that do not keep an
+   * order may return them in any order, or not at all.
+   */
+  virtual auto GetEvictionOrder() -> std::vector<frame_id_t> { return {}; }
+
   /** @return the number of elements in the replacer that can be victimized */
   virtual auto Size() -> size_t = 0;
 };
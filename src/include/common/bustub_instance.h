@@ -11,6 +11,7 @@
 //===----------------------------------------------------------------------===//
 
 #include <string>
+#include <vector>
 
 #include "buffer/buffer_pool_manager_instance.h"
 #include "common/config.h"
@@ -23,11 +24,17 @@ namespace bustub {
 
 class BustubInstance {
  public:
-  explicit BustubInstance(const std::string &db_file_name) {
+  /**
+   * @param db_file_name the database file; the log and the other files of the instance are kept next to it
+   * @param stripe_dirs directories of further data files to stripe the pages over, see DiskManager
+   */
+  explicit BustubInstance(const std::string &db_file_name, const std::vector<std::string> &stripe_dirs = {}) {
     enable_logging = false;
+    residency_file_name_ = db_file_name.substr(0, db_file_name.rfind('.')) + ".residency";
 
     // storage related
-    disk_manager_ = new DiskManager(db_file_name);
+    disk_manager_ = new DiskManager(db_file_name, DiskWriteMode::WRITE_BACK, DiskIOMode::BUFFERED, stripe_dirs);
+    disk_manager_->SetPageChecksums(true);
 
     // log related
     log_manager_ = new LogManager(disk_manager_);
@@ -40,9 +47,13 @@ class BustubInstance {
 
     // checkpoints
     checkpoint_manager_ = new CheckpointManager(transaction_manager_, log_manager_, buffer_pool_manager_);
+
+    // Warm the buffer pool up with the pages that were cached at the last shutdown.
+    buffer_pool_manager_->LoadResidency(residency_file_name_);
   }
 
   ~BustubInstance() {
+    buffer_pool_manager_->SaveResidency(residency_file_name_);
     if (enable_logging) {
       log_manager_->StopFlushThread();
     }
@@ -60,6 +71,8 @@ class BustubInstance {
   TransactionManager *transaction_manager_;
   LogManager *log_manager_;
   CheckpointManager *checkpoint_manager_;
+  /** Lists the pages cached at shutdown, next to the database file. */
+  std::string residency_file_name_;
 };
 
 }  // namespace bustub
@@ -27,14 +27,30 @@ extern std::atomic<bool> enable_logging;
 /** If ENABLE_LOGGING is true, the log should be flushed to disk every LOG_TIMEOUT. */
 extern std::chrono::duration<int64_t> log_timeout;
 
+/** A running background writer of a buffer pool instance wakes up every BACKGROUND_WRITER_INTERVAL. */
+extern std::chrono::milliseconds background_writer_interval;
+
 static constexpr int INVALID_PAGE_ID = -1;                                    // invalid page id
 static constexpr int INVALID_TXN_ID = -1;                                     // invalid transaction id
 static constexpr int INVALID_LSN = -1;                                        // invalid log sequence number
 static constexpr int HEADER_PAGE_ID = 0;                                      // the header page id
 static constexpr int PAGE_SIZE = 4096;                                        // size of a data page in byte
+static constexpr int PAGE_CHECKSUM_SIZE = 4;                                  // checksum slot at the end of a page
+static constexpr int PAGE_CONTENT_SIZE = PAGE_SIZE - PAGE_CHECKSUM_SIZE;      // bytes of a page usable by its type
 static constexpr int BUFFER_POOL_SIZE = 10;                                   // size of buffer pool
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                        // size of extendible hash bucket
+static constexpr size_t LRUK_REPLACER_K = 2;                                  // lookback window for lru-k replacer
+static constexpr size_t LRUK_CORRELATED_REFERENCE_PERIOD = 0;                 // accesses treated as one reference
+static constexpr size_t SCAN_RING_SIZE = 32;                                  // frames a bulk read may occupy
+static constexpr size_t BACKGROUND_WRITER_MAX_PAGES = 64;                     // pages written per writer round
+static constexpr size_t ASYNC_IO_QUEUE_DEPTH = 64;                            // page I/Os in flight per disk manager
+static constexpr size_t ASYNC_IO_NUM_THREADS = 8;                             // workers of the thread-pool backend
+static constexpr size_t FREE_PAGE_EXTENT_SIZE = 16;                           // freed pages claimed at a time
+static constexpr size_t STRIPE_NUM_PAGES = 64;                                // pages kept together in a data file
+static constexpr size_t MAPPED_SCAN_WINDOW_PAGES = 64;                        // pages advised ahead of a mapped scan
+static constexpr size_t PREALLOCATE_MIN_SIZE = 1 << 20;                       // first extent reserved in a data file
+static constexpr size_t PREALLOCATE_MAX_SIZE = 64 << 20;                      // largest extent reserved at a time
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
@@ -0,0 +1,161 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// latency_histogram.h
+//
+// Identification: src/include/common/latency_histogram.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * LatencyHistogram is a snapshot of a distribution of latencies in nanoseconds. Like an HDR histogram, it buckets
+ * values by powers of two, each split into NUM_SUB_BUCKETS linear sub-buckets, so that every value is known to within
+ * 12.5% from 1 ns up to about a minute with a few hundred counters.
+ */
+struct LatencyHistogram {
+  static constexpr size_t SUB_BUCKET_BITS = 3;
+  static constexpr size_t NUM_SUB_BUCKETS = size_t{1} << SUB_BUCKET_BITS;
+  /** Values of 2^(MAX_EXPONENT + 1) ns and more are counted in the last bucket. */
+  static constexpr size_t MAX_EXPONENT = 35;
+  static constexpr size_t NUM_BUCKETS = NUM_SUB_BUCKETS * (MAX_EXPONENT - SUB_BUCKET_BITS + 2);
+
+  /** Number of values in each bucket. */
+  std::array<size_t, NUM_BUCKETS> counts_{};
+  /** Number of values. */
+  size_t count_ = 0;
+  /** Sum of the values, in nanoseconds. */
+  size_t total_ns_ = 0;
+  /** Largest value, in nanoseconds. */
+  size_t max_ns_ = 0;
+
+  /** @return the bucket that counts the given value */
+  static auto BucketIndex(uint64_t ns) -> size_t {
+    if (ns < NUM_SUB_BUCKETS) {
+      return ns;
+    }
+    const size_t exponent = 63 - __builtin_clzll(ns);
+    if (exponent > MAX_EXPONENT) {
+      return NUM_BUCKETS - 1;
+    }
+    const size_t shift = exponent - SUB_BUCKET_BITS;
+    return ((shift + 1) << SUB_BUCKET_BITS) + ((ns >> shift) & (NUM_SUB_BUCKETS - 1));
+  }
+
+  /** @return the smallest value counted in the given bucket */
+  static auto BucketLowerBound(size_t index) -> uint64_t {
+    if (index < NUM_SUB_BUCKETS) {
+      return index;
+    }
+    const size_t shift = (index >> SUB_BUCKET_BITS) - 1;
+    return (NUM_SUB_BUCKETS + (index & (NUM_SUB_BUCKETS - 1))) << shift;
+  }
+
+  /** @return the largest value counted in the given bucket, except in the last bucket, which has no upper bound */
+  static auto BucketUpperBound(size_t index) -> uint64_t {
+    return index + 1 < NUM_BUCKETS ? BucketLowerBound(index + 1) - 1 : UINT64_MAX;
+  }
+
+  /** @return the mean value in nanoseconds, 0 if there are none */
+  auto Mean() const -> double { return count_ == 0 ? 0 : static_cast<double>(total_ns_) / count_; }
+
+  /**
+   * @param percentile the percentage of values, between 0 and 100, that are at most the result
+   * @return an upper bound of the percentile in nanoseconds, at most 12.5% above it; 0 if there are no values
+   */
+  auto Percentile(double percentile) const -> uint64_t {
+    const auto rank = std::max<size_t>(1, static_cast<size_t>(percentile / 100 * count_ + 0.5));
+    size_t seen = 0;
+    for (size_t i = 0; i < NUM_BUCKETS && count_ > 0; i++) {
+      seen += counts_[i];
+      if (seen >= rank) {
+        return std::min<uint64_t>(BucketUpperBound(i), max_ns_);
+      }
+    }
+    return max_ns_;
+  }
+
+  /** Add the values of another histogram. */
+  auto operator+=(const LatencyHistogram &other) -> LatencyHistogram & {
+    for (size_t i = 0; i < NUM_BUCKETS; i++) {
+      counts_[i] += other.counts_[i];
+    }
+    count_ += other.count_;
+    total_ns_ += other.total_ns_;
+    max_ns_ = std::max(max_ns_, other.max_ns_);
+    return *this;
+  }
+
+  /** @return a one-line, human readable summary, in microseconds */
+  auto ToString() const -> std::string {
+    std::ostringstream os;
+    os << "count=" << count_ << " mean_us=" << Mean() / 1000 << " p50_us=" << Percentile(50) / 1000.0
+       << " p99_us=" << Percentile(99) / 1000.0 << " p999_us=" << Percentile(99.9) / 1000.0
+       << " max_us=" << max_ns_ / 1000.0;
+    return os.str();
+  }
+};
+
+/**
+ * LatencyRecorder fills a LatencyHistogram from many threads. Recording a value costs a few relaxed atomic updates,
+ * so it can stay on in production.
+ */
+class LatencyRecorder {
+ public:
+  LatencyRecorder() = default;
+
+  DISALLOW_COPY(LatencyRecorder);
+
+  /** Record a value in nanoseconds. */
+  void Record(uint64_t ns) {
+    counts_[LatencyHistogram::BucketIndex(ns)].fetch_add(1, std::memory_order_relaxed);
+    total_ns_.fetch_add(ns, std::memory_order_relaxed);
+    uint64_t max_ns = max_ns_.load(std::memory_order_relaxed);
+    while (ns > max_ns && !max_ns_.compare_exchange_weak(max_ns, ns, std::memory_order_relaxed)) {
+    }
+  }
+
+  /** @return a snapshot of the values recorded so far; values recorded meanwhile may be partly included */
+  auto Snapshot() const -> LatencyHistogram {
+    LatencyHistogram histogram;
+    for (size_t i = 0; i < LatencyHistogram::NUM_BUCKETS; i++) {
+      histogram.counts_[i] = counts_[i].load(std::memory_order_relaxed);
+      histogram.count_ += histogram.counts_[i];
+    }
+    histogram.total_ns_ = total_ns_.load(std::memory_order_relaxed);
+    histogram.max_ns_ = max_ns_.load(std::memory_order_relaxed);
+    return histogram;
+  }
+
+  /** Forget the values recorded so far. */
+  void Reset() {
+    for (auto &count : counts_) {
+      count.store(0, std::memory_order_relaxed);
+    }
+    total_ns_.store(0, std::memory_order_relaxed);
+    max_ns_.store(0, std::memory_order_relaxed);
+  }
+
+ private:
+  std::array<std::atomic<size_t>, LatencyHistogram::NUM_BUCKETS> counts_{};
+  std::atomic<uint64_t> total_ns_ = 0;
+  std::atomic<uint64_t> max_ns_ = 0;
+};
+
+}  // namespace bustub
@@ -0,0 +1,75 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// striped_counter.h
+//
+// Identification: src/include/common/striped_counter.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * StripedCounter is a statistics counter for hot paths. Each thread increments one of several stripes on its own cache
+ * line with relaxed atomics, so concurrent increments do not contend; reads add up all the stripes.
+ */
+class StripedCounter {
+ public:
+  StripedCounter() = default;
+
+  DISALLOW_COPY(StripedCounter);
+
+  /** Add to the counter. */
+  void Add(size_t n = 1) { stripes_[StripeIndex()].value_.fetch_add(n, std::memory_order_relaxed); }
+
+  /** @return the current value of the counter */
+  auto Load() const -> size_t {
+    size_t value = 0;
+    for (const auto &stripe : stripes_) {
+      value += stripe.value_.load(std::memory_order_relaxed);
+    }
+    return value;
+  }
+
+  /**
+   * Reset the counter to zero. Increments that race with the reset are either included in the result or kept.
+   * @return the value of the counter before the reset
+   */
+  auto Reset() -> size_t {
+    size_t value = 0;
+    for (auto &stripe : stripes_) {
+      value += stripe.value_.exchange(0, std::memory_order_relaxed);
+    }
+    return value;
+  }
+
+ private:
+  static constexpr size_t NUM_STRIPES = 16;
+  static constexpr size_t CACHE_LINE_SIZE = 64;
+
+  struct alignas(CACHE_LINE_SIZE) Stripe {
+    std::atomic<size_t> value_ = 0;
+  };
+
+  /** @return the stripe of the calling thread; threads are assigned stripes round-robin */
+  static auto StripeIndex() -> size_t {
+    static std::atomic<size_t> next_index = 0;
+    thread_local size_t index = next_index.fetch_add(1, std::memory_order_relaxed) % NUM_STRIPES;
+    return index;
+  }
+
+  std::array<Stripe, NUM_STRIPES> stripes_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,41 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c_util.h
+//
+// Identification: src/include/common/util/crc32c_util.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bustub {
+
+/**
+ * Crc32cUtil computes CRC32C (Castagnoli) checksums, with the SSE4.2 crc32 instruction when the CPU has it and with a
+ * slicing-by-8 table lookup otherwise. Both produce the same checksums.
+ */
+class Crc32cUtil {
+ public:
+  /**
+   * @param data the bytes to checksum
+   * @param length the number of bytes
+   * @param crc the checksum of the bytes preceding data, to checksum a buffer in pieces
+   * @return the checksum of the bytes
+   */
+  static auto Crc32c(const char *data, size_t length, uint32_t crc = 0) -> uint32_t;
+
+  /** @return the checksum of the bytes, computed with the slicing-by-8 table lookup even if the CPU has SSE4.2 */
+  static auto Crc32cSoftware(const char *data, size_t length, uint32_t crc = 0) -> uint32_t;
+
+  /** @return true if Crc32c uses the SSE4.2 crc32 instruction */
+  static auto IsHardwareAccelerated() -> bool;
+};
+
+}  // namespace bustub
@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <queue>
 #include <string>
 #include <utility>
@@ -129,6 +130,13 @@ class ExtendibleHashTable {
    */
   auto FetchDirectoryPage() -> HashTableDirectoryPage *;
 
+  /**
+   * Fetches the directory page from the buffer pool manager, along with the page that holds it.
+   *
+   * @return a pair of the raw page and the directory page
+   */
+  auto FetchRawDirectoryPage() -> std::pair<Page *, HashTableDirectoryPage *>;
+
   /**
    * Fetches the a bucket page from the buffer pool manager using the bucket's page_id.
    *
@@ -162,14 +170,30 @@ class ExtendibleHashTable {
    */
   void Merge(Transaction *transaction, const KeyType &key, const ValueType &value);
 
+  /**
+   * Deletes the buckets dropped by merges if no lookup is in flight, i.e. if no lookup can still reach them through a
+   * directory it read before the merge. Buckets that cannot be deleted yet are kept for the next split or merge.
+   * Must be called while holding the table latch in write mode.
+   */
+  void DeleteRetiredBuckets();
+
+  /** Optimistic directory reads a lookup attempts before it read latches the directory page. */
+  static constexpr uint32_t OPTIMISTIC_READ_ATTEMPTS = 4;
+
   // member variables
   page_id_t directory_page_id_;
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
 
-  // Readers includes inserts and removes, writers are splits and merges
+  // Readers includes inserts and removes, writers are splits and merges. Lookups do not take it: they read the
+  // directory optimistically, and splits and merges write latch the directory page.
   ReaderWriterLatch table_latch_;
   HashFunction<KeyType> hash_fn_;
+
+  /** Number of lookups in flight. */
+  std::atomic<size_t> num_lookups_ = 0;
+  /** Buckets dropped by merges that are not deleted yet, protected by the table latch. */
+  std::vector<page_id_t> retired_bucket_page_ids_;
 };
 
 }  // namespace bustub
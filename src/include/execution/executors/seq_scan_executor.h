@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
 
 #include "execution/executor_context.h"
@@ -52,6 +53,8 @@ class SeqScanExecutor : public AbstractExecutor {
   const SeqScanPlanNode *plan_;
   TableHeap *table_heap_;
   Schema *schema_;
+  /** Ring of frames the scan reads through, so that it does not flush the buffer pool. */
+  std::unique_ptr<BufferAccessStrategy> strategy_;
   TableIterator iter_;
 };
 }  // namespace bustub
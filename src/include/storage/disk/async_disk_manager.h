@@ -0,0 +1,120 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_disk_manager.h
+//
+// Identification: src/include/storage/disk/async_disk_manager.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <future>  // NOLINT
+#include <mutex>   // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/** How an AsyncDiskManager performs its page I/O. */
+enum class AsyncIOBackend {
+  /** Requests are queued to the kernel through an io_uring submission queue and reaped by a completion thread. */
+  IO_URING,
+  /** Requests are handed to a pool of threads that issue blocking positional I/O. */
+  THREAD_POOL
+};
+
+/**
+ * AsyncDiskManager is a DiskManager that can keep many page reads and writes in flight at once. Each asynchronous
+ * request returns a future that becomes ready once the page is in the output buffer or in the file; the buffers must
+ * stay valid until then. The synchronous ReadPage and WritePage of the DiskManager keep working alongside.
+ *
+ * The io_uring backend is used if the kernel supports it, otherwise the thread-pool backend. Like all disk manager
+ * I/O, concurrent requests for the same page must be serialized by the caller.
+ */
+class AsyncDiskManager : public DiskManager {
+ public:
+  /**
+   * Creates a new async disk manager that writes to the specified database file.
+   * @param db_file the file name of the database file to write to
+   * @param write_mode whether writes are synced one by one or only by Sync and SyncLog
+   * @param io_mode whether page I/O bypasses the OS page cache
+   * @param queue_depth the maximum number of requests in flight in the kernel
+   * @param use_io_uring false to always use the thread-pool backend
+   */
+  explicit AsyncDiskManager(const std::string &db_file, DiskWriteMode write_mode = DiskWriteMode::WRITE_BACK,
+                            DiskIOMode io_mode = DiskIOMode::BUFFERED, size_t queue_depth = ASYNC_IO_QUEUE_DEPTH,
+                            bool use_io_uring = true);
+
+  /** Waits for the requests in flight and stops the backend. */
+  ~AsyncDiskManager() override;
+
+  /** Waits for the requests in flight, stops the backend and closes the files. */
+  void ShutDown() override;
+
+  /**
+   * Start reading a page from the database file.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer, which must stay valid until the future is ready
+   * @return a future that is ready once the page has been read, holding false if ReadPage would have failed
+   */
+  auto ReadPageAsync(page_id_t page_id, char *page_data) -> std::future<bool>;
+
+  /**
+   * Start writing a page to the database file.
+   * @param page_id id of the page
+   * @param page_data raw page data, which must stay valid and unchanged until the future is ready
+   * @return a future that is ready once the page has been written, holding false on an I/O error
+   */
+  auto WritePageAsync(page_id_t page_id, const char *page_data) -> std::future<bool>;
+
+  /** Submits all the reads at once, then waits for all of them. */
+  auto ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &page_data)
+      -> std::vector<bool> override;
+
+  /** @return the backend performing the I/O */
+  auto GetBackend() const -> AsyncIOBackend { return backend_; }
+
+ private:
+  struct Request;
+  struct Ring;
+
+  /** Queues a request to the backend; the page data must not be touched by the caller until its future is ready. */
+  auto Submit(Request *request) -> std::future<bool>;
+  /** Finishes a request once its data has been transferred, or it failed with the given result. */
+  void Complete(Request *request, int result);
+  void StopBackend();
+
+  auto SetUpRing(size_t queue_depth) -> bool;
+  void SubmitToRing(Request *request);
+  void CompletionLoop();
+
+  void WorkerLoop();
+
+  AsyncIOBackend backend_;
+  bool stopped_ = false;
+
+  /** io_uring backend. */
+  Ring *ring_ = nullptr;
+  std::thread completion_thread_;
+  std::mutex submit_latch_;
+  std::condition_variable slot_cv_;
+  size_t num_in_flight_ = 0;
+
+  /** Thread-pool backend. */
+  std::vector<std::thread> workers_;
+  std::mutex queue_latch_;
+  std::condition_variable queue_cv_;
+  std::deque<Request *> queue_;
+  bool stopping_ = false;
+};
+
+}  // namespace bustub
@@ -0,0 +1,111 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_io_stats.h
+//
+// Identification: src/include/storage/disk/disk_io_stats.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <sstream>
+#include <string>
+
+#include "common/latency_histogram.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/** The I/O operations of a disk manager whose latency is measured. */
+enum class IOOperation {
+  /** A page read. */
+  READ_PAGE,
+  /** A page write, or a vectored write of a run of pages. */
+  WRITE_PAGE,
+  /** A write of the log buffer. */
+  WRITE_LOG,
+  /** A sync of the database or the log file. */
+  SYNC
+};
+
+/** Why an I/O operation was issued. */
+enum class IOCategory {
+  /** Reading in pages that were not in the buffer pool, including prefetches. */
+  BUFFER_MISS,
+  /** Writing back dirty pages to make room, by the evicting thread or the background writer. */
+  EVICTION,
+  /** Flushing pages with FlushPage and FlushAllPages, e.g. for a checkpoint. */
+  CHECKPOINT,
+  /** Writing and syncing the log. */
+  WAL,
+  /** Anything else. */
+  OTHER
+};
+
+static constexpr size_t NUM_IO_OPERATIONS = 4;
+static constexpr size_t NUM_IO_CATEGORIES = 5;
+
+/**
+ * IOCategoryScope sets the category of the I/O that the calling thread issues while the scope lives. Scopes nest; the
+ * category is OTHER outside of any scope.
+ */
+class IOCategoryScope {
+ public:
+  explicit IOCategoryScope(IOCategory category) : previous_(current_) { current_ = category; }
+
+  ~IOCategoryScope() { current_ = previous_; }
+
+  DISALLOW_COPY_AND_MOVE(IOCategoryScope);
+
+  /** @return the category of the I/O issued by the calling thread */
+  static auto Current() -> IOCategory { return current_; }
+
+ private:
+  static inline thread_local IOCategory current_ = IOCategory::OTHER;
+  IOCategory previous_;
+};
+
+/** DiskIOStats is a snapshot of the latencies of the I/O operations of a disk manager, by caller category. */
+struct DiskIOStats {
+  /** Latency histograms indexed by operation, then category. */
+  std::array<std::array<LatencyHistogram, NUM_IO_CATEGORIES>, NUM_IO_OPERATIONS> latencies_;
+
+  /** @return the latencies of an operation issued for a category */
+  auto Get(IOOperation operation, IOCategory category) const -> const LatencyHistogram & {
+    return latencies_[static_cast<size_t>(operation)][static_cast<size_t>(category)];
+  }
+
+  /** @return the latencies of an operation over all categories */
+  auto Get(IOOperation operation) const -> LatencyHistogram {
+    LatencyHistogram histogram;
+    for (const auto &category_histogram : latencies_[static_cast<size_t>(operation)]) {
+      histogram += category_histogram;
+    }
+    return histogram;
+  }
+
+  /** @return a human readable summary, one line per operation and category that has any latency recorded */
+  auto ToString() const -> std::string {
+    static constexpr std::array<const char *, NUM_IO_OPERATIONS> OPERATION_NAMES = {"read_page", "write_page",
+                                                                                     "write_log", "sync"};
+    static constexpr std::array<const char *, NUM_IO_CATEGORIES> CATEGORY_NAMES = {"buffer_miss", "eviction",
+                                                                                   "checkpoint", "wal", "other"};
+    std::ostringstream os;
+    for (size_t i = 0; i < NUM_IO_OPERATIONS; i++) {
+      for (size_t j = 0; j < NUM_IO_CATEGORIES; j++) {
+        if (latencies_[i][j].count_ > 0) {
+          os << OPERATION_NAMES[i] << "/" << CATEGORY_NAMES[j] << ": " << latencies_[i][j].ToString() << "\n";
+        }
+      }
+    }
+    return os.str();
+  }
+};
+
+}  // namespace bustub
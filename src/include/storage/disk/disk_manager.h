@@ -12,34 +12,106 @@
 
 #pragma once
 
+#include <sys/types.h>
+
+#include <array>
 #include <atomic>
+#include <chrono>  // NOLINT
 #include <fstream>
 #include <future>  // NOLINT
-#include <mutex>   // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
 #include <string>
+#include <vector>
 
 #include "common/config.h"
+#include "storage/disk/disk_io_stats.h"
 
 namespace bustub {
 
+/** When written pages become durable. */
+enum class DiskWriteMode {
+  /** Writes reach the OS page cache; they are only durable after an explicit Sync. */
+  WRITE_BACK,
+  /** Every page and log write is synced to the device before it returns. */
+  WRITE_THROUGH
+};
+
+/** Whether page I/O goes through the OS page cache. */
+enum class DiskIOMode {
+  /** Pages are cached by the OS as well as by the buffer pool. */
+  BUFFERED,
+  /** Pages are transferred between the device and the caller's buffer with O_DIRECT, bypassing the OS page cache. */
+  DIRECT
+};
+
+/** How a scan is about to read mapped pages. */
+enum class MappedAccess {
+  /** The pages are read in order: read ahead aggressively and drop them soon after they are read. */
+  SEQUENTIAL,
+  /** The pages are read soon: start reading them in. */
+  WILL_NEED,
+  /** The scan is over: go back to the default read ahead. */
+  NORMAL
+};
+
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
+ *
+ * Pages are read and written with positional I/O on raw file descriptors, so page I/O from different threads runs
+ * concurrently. Concurrent I/O on the same page must be serialized by the caller, as the buffer pool does.
+ *
+ * The pages can be striped over several data files, e.g. on different devices: runs of STRIPE_NUM_PAGES consecutive
+ * pages are dealt out to the files round-robin, so that scans and parallel readers spread over all of them. The first
+ * data file is the database file itself, the others are named after it with their index, e.g. test.1.db. A database
+ * must always be opened with the same stripe directories.
+ *
+ * Data files grow by preallocated extents, starting at PREALLOCATE_MIN_SIZE and doubling up to PREALLOCATE_MAX_SIZE,
+ * so that the file system allocates large contiguous ranges instead of one block per new page. The next extent is
+ * reserved once the pages in use reach the last quarter of the current one. Preallocation does not change the file
+ * size, so pages never written still read as zeros.
+ *
+ * The latency of every page read, page write, log write and sync is recorded in a histogram by IOCategory, which
+ * callers set with an IOCategoryScope; log writes and syncs are always counted as WAL.
+ *
+ * For analytic sessions over a quiescent database, the data files can be mapped read-only, so that scans read pages
+ * straight from the OS page cache instead of copying them into buffer pool frames.
+ *
+ * In direct I/O mode, page buffers aligned to PAGE_SIZE, such as buffer pool frames, are handed to the kernel as they
+ * are; other buffers are copied through an aligned per-thread buffer.
+ *
+ * Deallocated pages are tracked in a free page bitmap, persisted next to the database file, so that their ids can be
+ * handed out again instead of growing the file. Claims are persisted as soon as they are made and deallocations on the
+ * next Sync or ShutDown, after the data files are synced, so that a page is never handed out twice, even across a
+ * crash, and never marked free before the writes that freed it are durable; a crash only leaks pages.
+ *
+ * With page checksums enabled, every page is written with a CRC32C of its content and id in its last
+ * PAGE_CHECKSUM_SIZE bytes, and every page read is verified against it, so that torn, corrupted and misdirected writes
+ * are detected; a page that fails verification fails the read. The checksum is stamped on a copy of the page, so pages
+ * may be written while they are being modified.
  */
 class DiskManager {
  public:
   /**
    * Creates a new disk manager that writes to the specified database file.
    * @param db_file the file name of the database file to write to
+   * @param write_mode whether writes are synced one by one or only by Sync and SyncLog
+   * @param io_mode whether page I/O bypasses the OS page cache; falls back to buffered I/O if the file system does
+   * not support direct I/O
+   * @param stripe_dirs directories of the data files the pages are striped over besides the database file, none to
+   * keep every page in the database file
    */
-  explicit DiskManager(const std::string &db_file);
+  explicit DiskManager(const std::string &db_file, DiskWriteMode write_mode = DiskWriteMode::WRITE_BACK,
+                       DiskIOMode io_mode = DiskIOMode::BUFFERED, const std::vector<std::string> &stripe_dirs = {});
 
-  ~DiskManager() = default;
+  /** Closes the database file if ShutDown was not called. */
+  virtual ~DiskManager();
 
   /**
    * Shut down the disk manager and close all the file resources.
    */
-  void ShutDown();
+  virtual void ShutDown();
 
   /**
    * Write a page to the database file.
@@ -49,11 +121,143 @@ class DiskManager {
   void WritePage(page_id_t page_id, const char *page_data);
 
   /**
-   * Read a page from the database file.
+   * Write a batch of pages to the database file in page id order. Each run of consecutive pages is written with a
+   * single vectored write, and write-through mode syncs once for the whole batch.
+   * @param page_ids ids of the pages, without duplicates
+   * @param page_data raw data of each page
+   */
+  void WritePages(const std::vector<page_id_t> &page_ids, const std::vector<const char *> &page_data);
+
+  /**
+   * Read a page from the database file. Pages that were allocated but never written read as zeros.
    * @param page_id id of the page
    * @param[out] page_data output buffer
+   * @return false if the page is past the end of the file, could not be read or failed checksum verification
+   */
+  auto ReadPage(page_id_t page_id, char *page_data) -> bool;
+
+  /**
+   * Read a batch of pages from the database file in one sweep in page id order.
+   * @param page_ids ids of the pages
+   * @param[out] page_data output buffer for each page
+   * @return for each page, whether it was read as ReadPage would have
    */
-  void ReadPage(page_id_t page_id, char *page_data);
+  virtual auto ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &page_data)
+      -> std::vector<bool>;
+
+  /**
+   * Extend the logical extent of the database file to include the given page, without writing it. The page reaches
+   * the file on its first write.
+   * @param page_id id of the allocated page
+   */
+  void AllocatePage(page_id_t page_id);
+
+  /** @return the number of pages in the logical extent of the database file, written or not */
+  auto GetNumPages() const -> page_id_t { return num_pages_; }
+
+  /**
+   * Mark a page of the logical extent as free, so that AllocateFreePages can hand its id out again.
+   * @param page_id id of the deallocated page
+   */
+  void DeallocatePage(page_id_t page_id);
+
+  /**
+   * Claim an extent of free pages for one instance of a parallel buffer pool. Instances only contend on the free page
+   * bitmap once per extent.
+   * @param num_instances the number of instances in the parallel buffer pool
+   * @param instance_index the instance the pages are for; every claimed page id mods back to it
+   * @param max_pages the most pages to claim
+   * @return the claimed page ids in ascending order, empty if no free page belongs to the instance
+   */
+  auto AllocateFreePages(uint32_t num_instances, uint32_t instance_index, size_t max_pages) -> std::vector<page_id_t>;
+
+  /** @return the number of free pages that can be claimed */
+  auto GetNumFreePages() const -> size_t { return num_free_pages_; }
+
+  /**
+   * Durability barrier for pages: once this returns, every page written before the call survives a crash. In
+   * WRITE_BACK mode, a checkpoint has to call this after flushing the buffer pool.
+   */
+  void Sync();
+
+  /**
+   * Durability barrier for the log: once this returns, every log record written before the call survives a crash.
+   * In WRITE_BACK mode, a log flush has to call this before it advances the persistent LSN.
+   */
+  void SyncLog();
+
+  /** @return the write mode of this disk manager */
+  auto GetWriteMode() const -> DiskWriteMode { return write_mode_; }
+
+  /** @return the I/O mode of page reads and writes, which is buffered if direct I/O was requested but unsupported */
+  auto GetIOMode() const -> DiskIOMode { return io_mode_; }
+
+  /**
+   * Enable or disable stamping and verifying page checksums. Must be set before the first page is read or written;
+   * pages written without checksums fail verification.
+   * @param enabled true to enable page checksums
+   */
+  void SetPageChecksums(bool enabled) { page_checksums_ = enabled; }
+
+  /** @return true if page checksums are stamped and verified */
+  auto HasPageChecksums() const -> bool { return page_checksums_; }
+
+  /** @return the number of page reads that failed checksum verification */
+  auto GetNumChecksumFailures() const -> int { return num_checksum_failures_; }
+
+  /**
+   * Compute the checksum of a page, over its content and its id.
+   * @param page_id id of the page
+   * @param page_data raw page data; only the first PAGE_CONTENT_SIZE bytes are checksummed
+   * @return the checksum stored in the page trailer
+   */
+  static auto ComputePageChecksum(page_id_t page_id, const char *page_data) -> uint32_t;
+
+  /**
+   * Map the data files read-only, as far as they have been written. Pages written afterwards may not be visible in the
+   * mapping, so the database must not be written while it is mapped. Mapped pages are not checksum-verified.
+   * @return false if a data file could not be mapped, in which case none is
+   */
+  auto MapDataFiles() -> bool;
+
+  /** Unmap the data files. No mapped page may be in use. */
+  void UnmapDataFiles();
+
+  /**
+   * @param page_id id of the page
+   * @return the page in the read-only mapping of the data files, nullptr if the files are not mapped or the page was
+   * not written before they were
+   */
+  auto GetMappedPage(page_id_t page_id) const -> const char *;
+
+  /**
+   * Tell the kernel how a run of mapped pages is about to be read. Pages that are not mapped are skipped.
+   * @param page_id id of the first page
+   * @param num_pages the number of pages, clamped to the logical extent
+   * @param access how the pages are read
+   */
+  void AdviseMappedPages(page_id_t page_id, size_t num_pages, MappedAccess access);
+
+  /** @return the number of mapped pages advised by AdviseMappedPages */
+  auto GetNumAdvisedPages() const -> size_t { return num_advised_pages_; }
+
+  /**
+   * Enable or disable preallocating extents as the data files grow.
+   * @param enabled true to preallocate extents, the default
+   */
+  void SetPreallocation(bool enabled) { preallocate_ = enabled; }
+
+  /** @return the number of extents preallocated in the data files */
+  auto GetNumPreallocations() const -> int { return num_preallocations_; }
+
+  /** @return a snapshot of the latency histograms of the I/O operations, by caller category */
+  auto GetIOStats() const -> DiskIOStats;
+
+  /** Reset the latency histograms. */
+  void ResetIOStats();
+
+  /** @return the number of syncs of the database and log files */
+  auto GetNumSyncs() const -> int { return num_syncs_; }
 
   /**
    * Flush the entire log buffer into disk.
@@ -80,6 +284,18 @@ class DiskManager {
   /** @return the number of disk writes */
   auto GetNumWrites() const -> int;
 
+  /** @return the number of blocking write system calls issued for pages, a vectored write counting once */
+  auto GetNumWriteCalls() const -> int { return num_write_calls_; }
+
+  /** @return the total size of the data files in bytes, as extended by this disk manager's writes */
+  auto GetDbFileSize() const -> size_t;
+
+  /** @return the number of data files the pages are striped over */
+  auto GetNumDataFiles() const -> size_t { return data_files_.size(); }
+
+  /** @return the name of the data file that holds the page */
+  auto GetDataFileName(page_id_t page_id) const -> const std::string & { return GetDataFile(page_id).name_; }
+
   /**
    * Sets the future which is used to check for non-blocking flushes.
    * @param f the non-blocking flush check
@@ -89,20 +305,158 @@ class DiskManager {
   /** Checks if the non-blocking flush future was set. */
   inline auto HasFlushLogFuture() -> bool { return flush_log_f_ != nullptr; }
 
+ protected:
+  /** A file holding every num-data-files-th stripe of pages. */
+  struct DataFile {
+    std::string name_;
+    // file descriptor, -1 once shut down
+    int fd_ = -1;
+    // Size of the file, kept up to date by writes so that reads never have to stat the file
+    std::atomic<size_t> size_ = 0;
+    // Serializes preallocations
+    std::mutex preallocate_latch_;
+    // End of the preallocated extents
+    size_t preallocated_ = 0;
+    // Size of the next extent to preallocate
+    size_t extent_size_ = PREALLOCATE_MIN_SIZE;
+    // Pages in use up to this offset do not need another extent yet
+    std::atomic<size_t> preallocate_at_ = 0;
+    // Read-only mapping of the file, nullptr if it is not mapped
+    char *mapping_ = nullptr;
+    size_t mapping_size_ = 0;
+  };
+
+  /** @return the data file that holds the page */
+  auto GetDataFile(page_id_t page_id) const -> DataFile & {
+    return *data_files_[(page_id / STRIPE_NUM_PAGES) % data_files_.size()];
+  }
+
+  /** @return the offset of the page in its data file */
+  auto GetFileOffset(page_id_t page_id) const -> size_t {
+    const size_t stripe = page_id / STRIPE_NUM_PAGES / data_files_.size();
+    return (stripe * STRIPE_NUM_PAGES + page_id % STRIPE_NUM_PAGES) * PAGE_SIZE;
+  }
+
+  /**
+   * Handles reads that do not touch the file: pages past the logical extent and pages never written.
+   * @param[out] from_file set to true if the page has to be read from the file
+   * @return false if the page is past the logical extent
+   */
+  auto BeginRead(page_id_t page_id, char *page_data, bool *from_file) -> bool;
+
+  /**
+   * Read the rest of a page from the file, starting after the bytes already read.
+   * @return the number of bytes of the page read in total, or -1 on an I/O error
+   */
+  auto ReadFrom(page_id_t page_id, char *page_data, size_t read_count) -> ssize_t;
+
+  /**
+   * Zero-fills the part of the page beyond the end of the file and verifies the page checksum.
+   * @return false if the page failed checksum verification
+   */
+  auto EndRead(page_id_t page_id, char *page_data, size_t read_count) -> bool;
+
+  /** Stores the checksum of a page in its trailer if page checksums are enabled. */
+  void StampChecksum(page_id_t page_id, char *page_data) const;
+
+  /** @return true if the page must be copied before it is written, to stamp its checksum or to align it */
+  auto NeedsCopyForWrite(const char *page_data) const -> bool { return page_checksums_ || NeedsBounce(page_data); }
+
+  /**
+   * Write the rest of a page to the file, starting after the bytes already written.
+   * @return false on an I/O error
+   */
+  auto WriteFrom(page_id_t page_id, const char *page_data, size_t written) -> bool;
+
+  /** Extends the file size and the logical extent over a written page, and syncs it in write-through mode. */
+  void EndWrite(page_id_t page_id);
+
+  /** Extends the data file size and the logical extent over a written page. */
+  void ExtendFile(page_id_t page_id);
+
+  /** Preallocates extents in the data file until it reaches well past the page. */
+  void Preallocate(page_id_t page_id);
+
+  /** Load the free page bitmap, keeping the pages of the logical extent only. */
+  void LoadFreePages();
+
+  /** Atomically replace the persisted free page bitmap. Must be called while holding free_pages_latch_. */
+  void SaveFreePages(const std::vector<uint64_t> &bitmap);
+
+  /**
+   * Sync every data file.
+   * @return false if any of them could not be synced
+   */
+  auto SyncDataFiles() -> bool;
+
+  /**
+   * Record the latency of an I/O operation that started at the given time.
+   * @param operation the operation
+   * @param category the category of the caller
+   * @param start when the operation started, or was submitted
+   */
+  void RecordLatency(IOOperation operation, IOCategory category, std::chrono::steady_clock::time_point start) {
+    const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    latencies_[static_cast<size_t>(operation) * NUM_IO_CATEGORIES + static_cast<size_t>(category)].Record(ns.count());
+  }
+
+  /** @return true if the buffer cannot be handed to the kernel as it is, because it is not aligned for direct I/O */
+  auto NeedsBounce(const char *page_data) const -> bool {
+    return io_mode_ == DiskIOMode::DIRECT && reinterpret_cast<uintptr_t>(page_data) % PAGE_SIZE != 0;
+  }
+
+  // data files the pages are striped over, the db file first
+  std::vector<std::unique_ptr<DataFile>> data_files_;
+  std::atomic<int> num_writes_;
+  std::atomic<int> num_write_calls_ = 0;
+  bool page_checksums_ = false;
+  bool preallocate_ = true;
+  std::atomic<int> num_preallocations_ = 0;
+  std::atomic<size_t> num_advised_pages_ = 0;
+  // Latency of each operation and category, indexed by operation * NUM_IO_CATEGORIES + category
+  std::array<LatencyRecorder, NUM_IO_OPERATIONS * NUM_IO_CATEGORIES> latencies_;
+  std::atomic<int> num_checksum_failures_ = 0;
+
  private:
   auto GetFileSize(const std::string &file_name) -> int;
+
+  /**
+   * Open or create the data files, with direct I/O if requested and supported by all of them.
+   * @throw Exception if a data file can't be opened
+   */
+  void OpenDataFiles(const std::vector<std::string> &file_names);
+
+  /**
+   * Write a run of consecutive pages with one vectored write, finishing a short or failed write page by page.
+   * @return false on an I/O error
+   */
+  auto WriteRun(const page_id_t *page_ids, const char *const *page_data, size_t num_pages) -> bool;
+
   // stream to write log file
   std::fstream log_io_;
   std::string log_name_;
-  // stream to write db file
-  std::fstream db_io_;
+  // file descriptor of the log file, only used to sync it; -1 if it could not be opened
+  int log_fd_ = -1;
   std::string file_name_;
   int num_flushes_;
-  int num_writes_;
+  std::atomic<int> num_syncs_ = 0;
+  const DiskWriteMode write_mode_;
+  DiskIOMode io_mode_;
   bool flush_log_;
   std::future<void> *flush_log_f_;
-  // With multiple buffer pool instances, need to protect file access
-  std::mutex db_io_latch_;
+  // Logical extent of the db file in pages, including allocated pages that have not been written yet
+  std::atomic<page_id_t> num_pages_;
+  // File holding the free page bitmap, next to the db file
+  std::string free_pages_name_;
+  // Protects the free page bitmaps
+  std::mutex free_pages_latch_;
+  // One bit per page of the logical extent, set if the page is free
+  std::vector<uint64_t> free_pages_;
+  // The free pages as persisted: claims are cleared right away, deallocations are only added by Sync
+  std::vector<uint64_t> durable_free_pages_;
+  std::atomic<size_t> num_free_pages_ = 0;
+  // True if free_pages_ has deallocations that are not persisted yet
+  bool free_pages_dirty_ = false;
 };
 
 }  // namespace bustub
@@ -22,11 +22,12 @@
 /**
  * BLOCK_ARRAY_SIZE is the number of (key, value) pairs that can be stored in a linear probe hash block page. It is an
  * approximate calculation based on the size of MappingType (which is a std::pair of KeyType and ValueType). For each
- * key/value pair, we need two additional bits for occupied_ and readable_. 4 * PAGE_SIZE / (4 * sizeof (MappingType) +
- * 1) = PAGE_SIZE/(sizeof (MappingType) + 0.25) because 0.25 bytes = 2 bits is the space required to maintain the
- * occupied and readable flags for a key value pair.
+ * key/value pair, we need two additional bits for occupied_ and readable_. 4 * PAGE_CONTENT_SIZE / (4 * sizeof
+ * (MappingType) + 1) = PAGE_CONTENT_SIZE/(sizeof (MappingType) + 0.25) because 0.25 bytes = 2 bits is the space
+ * required to maintain the occupied and readable flags for a key value pair. It is based on PAGE_CONTENT_SIZE rather
+ * than PAGE_SIZE because the last PAGE_CHECKSUM_SIZE bytes of the page are reserved for the disk manager's checksum.
  */
-#define BLOCK_ARRAY_SIZE (4 * PAGE_SIZE / (4 * sizeof(MappingType) + 1))
+#define BLOCK_ARRAY_SIZE (4 * PAGE_CONTENT_SIZE / (4 * sizeof(MappingType) + 1))
 
 /**
  * Extendible Hashing Definitions
@@ -37,8 +38,9 @@
 /**
  * BUCKET_ARRAY_SIZE is the number of (key, value) pairs that can be stored in an extendible hashing bucket page.
  * It is an approximate calculation based on the size of MappingType (which is a std::pair of KeyType and ValueType).
- * For each key/value pair, we need two additional bits for occupied_ and readable_. 4 * (PAGE_SIZE - 4) / (4 * sizeof
- * (MappingType) + 1) = (PAGE_SIZE - 4)/(sizeof (MappingType) + 0.25) because 0.25 bytes = 2 bits is the space required
- * to maintain the occupied and readable flags for a key value pair.
+ * For each key/value pair, we need two additional bits for occupied_ and readable_. 4 * PAGE_CONTENT_SIZE / (4 * sizeof
+ * (MappingType) + 1) = PAGE_CONTENT_SIZE/(sizeof (MappingType) + 0.25) because 0.25 bytes = 2 bits is the space
+ * required to maintain the occupied and readable flags for a key value pair. As for BLOCK_ARRAY_SIZE, the disk
+ * manager's checksum takes the last PAGE_CHECKSUM_SIZE bytes of the page.
  */
-#define BUCKET_ARRAY_SIZE (4 * PAGE_SIZE / (4 * sizeof(MappingType) + 1))
+#define BUCKET_ARRAY_SIZE (4 * PAGE_CONTENT_SIZE / (4 * sizeof(MappingType) + 1))
@@ -12,10 +12,13 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
 
 #include "common/config.h"
+#include "common/macros.h"
 #include "common/rwlatch.h"
 
 namespace bustub {
@@ -24,17 +27,43 @@ namespace bustub {
  * Page is the basic unit of storage within the database system. Page provides a wrapper for actual data pages being
  * held in main memory. Page also contains book-keeping information that is used by the buffer pool manager, e.g.
  * pin count, dirty flag, page id, etc.
+ *
+ * The page data is kept apart from the book-keeping information and aligned to PAGE_SIZE, so that it can be handed to
+ * the kernel for direct I/O. Its last PAGE_CHECKSUM_SIZE bytes hold the checksum stamped by the disk manager, so page
+ * types only lay out the first PAGE_CONTENT_SIZE bytes.
  */
 class Page {
   // There is book-keeping information inside the page that should only be relevant to the buffer pool manager.
   friend class BufferPoolManagerInstance;
 
  public:
-  /** Constructor. Zeros out the page data. */
-  Page() { ResetMemory(); }
-
-  /** Default destructor. */
-  ~Page() = default;
+  /** Constructor. Allocates the page data and zeros it out. */
+  Page() : data_(static_cast<char *>(std::aligned_alloc(PAGE_SIZE, PAGE_SIZE))), owns_data_(true) { ResetMemory(); }
+
+  /**
+   * Constructor. Zeros out the page data, which lives in memory owned by the caller, such as a frame arena.
+   * @param data PAGE_SIZE bytes of memory that outlive the page
+   */
+  explicit Page(char *data) : data_(data), owns_data_(false) { ResetMemory(); }
+
+  /** Tag of the constructor that views page data without touching it. */
+  struct ViewTag {};
+
+  /**
+   * Constructor. Views page data owned by the caller without zeroing it, such as a page in a read-only mapping of the
+   * database files. The page data of a view must only be read.
+   * @param data PAGE_SIZE bytes of memory that outlive the page
+   */
+  Page(const char *data, ViewTag /* unused */) : data_(const_cast<char *>(data)), owns_data_(false) {}
+
+  /** Destructor. Frees the page data if the page allocated it. */
+  ~Page() {
+    if (owns_data_) {
+      free(data_);
+    }
+  }
+
+  DISALLOW_COPY(Page);
 
   /** @return the actual data contained within this page */
   inline auto GetData() -> char * { return data_; }
@@ -48,11 +77,18 @@ class Page {
   /** @return true if the page in memory has been modified from the page on disk, false otherwise */
   inline auto IsDirty() -> bool { return is_dirty_; }
 
-  /** Acquire the page write latch. */
-  inline void WLatch() { rwlatch_.WLock(); }
+  /** Acquire the page write latch. The page version stays odd until the latch is released. */
+  inline void WLatch() {
+    rwlatch_.WLock();
+    version_.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
 
   /** Release the page write latch. */
-  inline void WUnlatch() { rwlatch_.WUnlock(); }
+  inline void WUnlatch() {
+    version_.fetch_add(1, std::memory_order_release);
+    rwlatch_.WUnlock();
+  }
 
   /** Acquire the page read latch. */
   inline void RLatch() { rwlatch_.RLock(); }
@@ -60,6 +96,23 @@ class Page {
   /** Release the page read latch. */
   inline void RUnlatch() { rwlatch_.RUnlock(); }
 
+  /**
+   * Begin an optimistic read of the page. No latch is taken and nothing is written, so anything read from the page
+   * until ValidateVersion succeeds may be torn and must not be acted upon.
+   * @return the page version; odd if a writer holds the write latch, in which case validation always fails
+   */
+  inline auto GetVersion() -> uint64_t { return version_.load(std::memory_order_acquire); }
+
+  /**
+   * Finish an optimistic read of the page.
+   * @param version the version returned by GetVersion when the read began
+   * @return true if no writer latched the page since then, i.e. everything read in between is consistent
+   */
+  inline auto ValidateVersion(uint64_t version) -> bool {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version % 2 == 0 && version_.load(std::memory_order_relaxed) == version;
+  }
+
   /** @return the page LSN. */
   inline auto GetLSN() -> lsn_t { return *reinterpret_cast<lsn_t *>(GetData() + OFFSET_LSN); }
 
@@ -79,15 +132,21 @@ class Page {
   inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, PAGE_SIZE); }
 
   /** The actual data that is stored within a page. */
-  char data_[PAGE_SIZE]{};
+  char *data_;
+  /** True if data_ was allocated by the page itself. */
+  bool owns_data_;
   /** The ID of this page. */
-  page_id_t page_id_ = INVALID_PAGE_ID;
+  std::atomic<page_id_t> page_id_ = INVALID_PAGE_ID;
   /** The pin count of this page. */
-  int pin_count_ = 0;
+  std::atomic<int> pin_count_ = 0;
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
-  bool is_dirty_ = false;
+  std::atomic<bool> is_dirty_ = false;
+  /** True while the page is being read in from disk. Protected by the owning page table shard's latch. */
+  bool is_loading_ = false;
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
+  /** Incremented when the write latch is acquired and again when it is released, for optimistic readers. */
+  std::atomic<uint64_t> version_ = 0;
 };
 
 }  // namespace bustub
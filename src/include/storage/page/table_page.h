@@ -26,12 +26,14 @@ namespace bustub {
 
 /**
  * Slotted page format:
- *  ---------------------------------------------------------
- *  | HEADER | ... FREE SPACE ... | ... INSERTED TUPLES ... |
- *  ---------------------------------------------------------
+ *  --------------------------------------------------------------------
+ *  | HEADER | ... FREE SPACE ... | ... INSERTED TUPLES ... | CHECKSUM |
+ *  --------------------------------------------------------------------
  *                                ^
  *                                free space pointer
  *
+ *  The page size given to Init excludes the checksum slot, which belongs to the disk manager.
+ *
  *  Header format (size in bytes):
  *  ----------------------------------------------------------------------------
  *  | PageId (4)| LSN (4)| PrevPageId (4)| NextPageId (4)| FreeSpacePointer(4) |
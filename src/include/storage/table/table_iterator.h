@@ -14,6 +14,7 @@
 
 #include <cassert>
 
+#include "buffer/buffer_access_strategy.h"
 #include "common/rid.h"
 #include "concurrency/transaction.h"
 #include "storage/table/tuple.h"
@@ -21,6 +22,7 @@
 namespace bustub {
 
 class TableHeap;
+class TablePage;
 
 /**
  * TableIterator enables the sequential scan of a TableHeap.
@@ -29,12 +31,20 @@ class TableIterator {
   friend class Cursor;
 
  public:
-  TableIterator(TableHeap *table_heap, RID rid, Transaction *txn);
+  TableIterator(TableHeap *table_heap, RID rid, Transaction *txn, BufferAccessStrategy *strategy = nullptr);
 
+  /** A copy starts without a read-ahead window, so that destroying it leaves the advice of the original alone. */
   TableIterator(const TableIterator &other)
-      : table_heap_(other.table_heap_), tuple_(new Tuple(*other.tuple_)), txn_(other.txn_) {}
-
-  ~TableIterator() { delete tuple_; }
+      : table_heap_(other.table_heap_),
+        tuple_(new Tuple(*other.tuple_)),
+        txn_(other.txn_),
+        strategy_(other.strategy_),
+        prefetched_page_id_(other.prefetched_page_id_) {}
+
+  ~TableIterator() {
+    EndReadAhead();
+    delete tuple_;
+  }
 
   inline auto operator==(const TableIterator &itr) const -> bool {
     return tuple_->rid_.Get() == itr.tuple_->rid_.Get();
@@ -51,16 +61,49 @@ class TableIterator {
   auto operator++(int) -> TableIterator;
 
   auto operator=(const TableIterator &other) -> TableIterator & {
+    EndReadAhead();
     table_heap_ = other.table_heap_;
     *tuple_ = *other.tuple_;
     txn_ = other.txn_;
+    strategy_ = other.strategy_;
+    prefetched_page_id_ = other.prefetched_page_id_;
     return *this;
   }
 
  private:
+  /**
+   * Move to the next tuple reading the pages straight from the read-only mapping of the database files, which skips
+   * pinning them in the buffer pool.
+   * @return false, without moving, if mapped reads are off or a page on the way is not mapped
+   */
+  auto AdvanceMapped() -> bool;
+
+  /**
+   * Start reading the page after the given one, the first time the iterator is on that page. The heap is a linked
+   * list of pages, so the page after next is only known once the next page has been read.
+   */
+  void PrefetchNextPage(TablePage *page);
+
+  /**
+   * Advise sequential access over a window of MAPPED_SCAN_WINDOW_PAGES mapped pages from the given page, unless the
+   * window advised last still reaches well beyond it. The pages of a heap are mostly allocated in order, so they are
+   * mostly in order in the database files.
+   */
+  void AdviseReadAhead(page_id_t page_id);
+
+  /** Reset the pages advised by AdviseReadAhead to normal access, once the scan is over. */
+  void EndReadAhead();
+
   TableHeap *table_heap_;
   Tuple *tuple_;
   Transaction *txn_;
+  /** Access strategy used when moving on to the next page, not owned by the iterator. */
+  BufferAccessStrategy *strategy_;
+  /** The page whose successor has been prefetched last. */
+  page_id_t prefetched_page_id_ = INVALID_PAGE_ID;
+  /** The range of pages advised for sequential access so far, empty if both are invalid. */
+  page_id_t read_ahead_begin_ = INVALID_PAGE_ID;
+  page_id_t read_ahead_end_ = INVALID_PAGE_ID;
 };
 
 }  // namespace bustub
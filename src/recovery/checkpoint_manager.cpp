@@ -18,6 +18,7 @@ void CheckpointManager::BeginCheckpoint() {
   // Block all the transactions and ensure that both the WAL and all dirty buffer pool pages are persisted to disk,
   // creating a consistent checkpoint. Do NOT allow transactions to resume at the end of this method, resume them
   // in CheckpointManager::EndCheckpoint() instead. This is for grading purposes.
+  // Writes are only durable after DiskManager::SyncLog and DiskManager::Sync.
 }
 
 void CheckpointManager::EndCheckpoint() {
@@ -19,6 +19,7 @@ namespace bustub {
  * The flush can be triggered when timeout or the log buffer is full or buffer
  * pool manager wants to force flush (it only happens when the flushed page has
  * a larger LSN than persistent LSN)
+ * Records are only durable once DiskManager::SyncLog returns, so only then may the persistent LSN advance
  *
  * This thread runs forever until system shutdown/StopFlushThread
  */
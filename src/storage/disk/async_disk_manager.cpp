@@ -0,0 +1,373 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_disk_manager.cpp
+//
+// Identification: src/storage/disk/async_disk_manager.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/async_disk_manager.h"
+
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>  // NOLINT
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#define BUSTUB_HAVE_IO_URING 1
+#endif
+
+#include "common/logger.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+struct AsyncDiskManager::Request {
+  bool is_write_;
+  page_id_t page_id_;
+  char *data_;
+  /** Aligned copy of the page handed to io_uring in direct I/O mode if data_ is unaligned, otherwise null. */
+  char *bounce_;
+  /** The single buffer of a vectored io_uring request; it has to live until the request completes. */
+  struct iovec iov_;
+  /** Holds whether the request succeeded. */
+  std::promise<bool> promise_;
+  /** The category of the submitting thread. */
+  IOCategory category_;
+  /** When the request was submitted; its latency includes the time it waited in the queue. */
+  std::chrono::steady_clock::time_point start_;
+};
+
+#ifdef BUSTUB_HAVE_IO_URING
+
+/**
+ * The rings shared with the kernel. The submission queue tail and the completion queue head are only written by this
+ * process; the other ends are written by the kernel, so they are read with acquire and written with release ordering.
+ */
+struct AsyncDiskManager::Ring {
+  ~Ring() {
+    if (sqes_ != MAP_FAILED) {
+      munmap(sqes_, sqes_size_);
+    }
+    if (cq_ptr_ != MAP_FAILED && cq_ptr_ != sq_ptr_) {
+      munmap(cq_ptr_, cq_size_);
+    }
+    if (sq_ptr_ != MAP_FAILED) {
+      munmap(sq_ptr_, sq_size_);
+    }
+    if (fd_ >= 0) {
+      close(fd_);
+    }
+  }
+
+  /** Asks the kernel to consume the pending submissions and, if min_complete > 0, to wait for completions. */
+  auto Enter(unsigned to_submit, unsigned min_complete, unsigned flags) -> int {
+    return syscall(__NR_io_uring_enter, fd_, to_submit, min_complete, flags, nullptr, _NSIG / 8);
+  }
+
+  int fd_ = -1;
+  void *sq_ptr_ = MAP_FAILED;
+  size_t sq_size_ = 0;
+  void *cq_ptr_ = MAP_FAILED;
+  size_t cq_size_ = 0;
+  void *sqes_ = MAP_FAILED;
+  size_t sqes_size_ = 0;
+
+  unsigned *sq_head_;
+  unsigned *sq_tail_;
+  unsigned sq_mask_;
+  unsigned *sq_array_;
+  io_uring_sqe *sqe_array_;
+  unsigned sq_entries_;
+
+  unsigned *cq_head_;
+  unsigned *cq_tail_;
+  unsigned cq_mask_;
+  io_uring_cqe *cqe_array_;
+};
+
+#else
+
+struct AsyncDiskManager::Ring {};
+
+#endif
+
+AsyncDiskManager::AsyncDiskManager(const std::string &db_file, DiskWriteMode write_mode, DiskIOMode io_mode,
+                                   size_t queue_depth, bool use_io_uring)
+    : DiskManager(db_file, write_mode, io_mode) {
+  BUSTUB_ASSERT(queue_depth > 0, "The queue needs room for at least one request");
+  if (use_io_uring && SetUpRing(queue_depth)) {
+    backend_ = AsyncIOBackend::IO_URING;
+    completion_thread_ = std::thread(&AsyncDiskManager::CompletionLoop, this);
+    return;
+  }
+  backend_ = AsyncIOBackend::THREAD_POOL;
+  for (size_t i = 0; i < std::min(queue_depth, ASYNC_IO_NUM_THREADS); i++) {
+    workers_.emplace_back(&AsyncDiskManager::WorkerLoop, this);
+  }
+}
+
+AsyncDiskManager::~AsyncDiskManager() { StopBackend(); }
+
+void AsyncDiskManager::ShutDown() {
+  StopBackend();
+  DiskManager::ShutDown();
+}
+
+auto AsyncDiskManager::ReadPageAsync(page_id_t page_id, char *page_data) -> std::future<bool> {
+  bool from_file = false;
+  const bool read = BeginRead(page_id, page_data, &from_file);
+  if (!from_file) {
+    std::promise<bool> done;
+    done.set_value(read);
+    return done.get_future();
+  }
+  return Submit(new Request{false, page_id, page_data, nullptr, {}, {}, IOCategoryScope::Current(),
+                            std::chrono::steady_clock::now()});
+}
+
+auto AsyncDiskManager::WritePageAsync(page_id_t page_id, const char *page_data) -> std::future<bool> {
+  num_writes_ += 1;
+  return Submit(new Request{true, page_id, const_cast<char *>(page_data), nullptr, {}, {}, IOCategoryScope::Current(),
+                            std::chrono::steady_clock::now()});
+}
+
+auto AsyncDiskManager::ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &page_data)
+    -> std::vector<bool> {
+  BUSTUB_ASSERT(page_ids.size() == page_data.size(), "Every page needs an output buffer");
+  std::vector<std::future<bool>> reads;
+  reads.reserve(page_ids.size());
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    reads.push_back(ReadPageAsync(page_ids[i], page_data[i]));
+  }
+  std::vector<bool> read(page_ids.size());
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    read[i] = reads[i].get();
+  }
+  return read;
+}
+
+auto AsyncDiskManager::Submit(Request *request) -> std::future<bool> {
+  BUSTUB_ASSERT(!stopped_, "The disk manager has been shut down");
+  auto future = request->promise_.get_future();
+  if (backend_ == AsyncIOBackend::IO_URING) {
+    // The thread-pool backend bounces unaligned pages and stamps checksums itself, one copy per worker.
+    if (request->is_write_ ? NeedsCopyForWrite(request->data_) : NeedsBounce(request->data_)) {
+      request->bounce_ = static_cast<char *>(std::aligned_alloc(PAGE_SIZE, PAGE_SIZE));
+      if (request->is_write_) {
+        memcpy(request->bounce_, request->data_, PAGE_SIZE);
+        StampChecksum(request->page_id_, request->bounce_);
+      }
+    }
+    SubmitToRing(request);
+  } else {
+    {
+      auto lock = std::lock_guard(queue_latch_);
+      queue_.push_back(request);
+    }
+    queue_cv_.notify_one();
+  }
+  return future;
+}
+
+void AsyncDiskManager::Complete(Request *request, int result) {
+  // A short transfer is finished with blocking I/O, a failed one is retried with it, which also reports the error.
+  size_t done = std::max(result, 0);
+  char *buffer = request->bounce_ != nullptr ? request->bounce_ : request->data_;
+  bool succeeded = false;
+  if (request->is_write_) {
+    succeeded = WriteFrom(request->page_id_, buffer, done);
+    RecordLatency(IOOperation::WRITE_PAGE, request->category_, request->start_);
+    if (succeeded) {
+      EndWrite(request->page_id_);
+    }
+  } else {
+    ssize_t read_count = ReadFrom(request->page_id_, buffer, done);
+    RecordLatency(IOOperation::READ_PAGE, request->category_, request->start_);
+    if (read_count >= 0) {
+      if (buffer != request->data_) {
+        memcpy(request->data_, buffer, read_count);
+      }
+      succeeded = EndRead(request->page_id_, request->data_, read_count);
+    }
+  }
+  free(request->bounce_);
+  request->promise_.set_value(succeeded);
+  delete request;
+}
+
+void AsyncDiskManager::StopBackend() {
+  if (stopped_) {
+    return;
+  }
+  stopped_ = true;
+  if (backend_ == AsyncIOBackend::IO_URING) {
+    // The completion of a null request tells the completion thread to exit.
+    SubmitToRing(nullptr);
+    completion_thread_.join();
+    delete ring_;
+    ring_ = nullptr;
+    return;
+  }
+  {
+    auto lock = std::lock_guard(queue_latch_);
+    stopping_ = true;
+  }
+  queue_cv_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+  workers_.clear();
+}
+
+#ifdef BUSTUB_HAVE_IO_URING
+
+auto AsyncDiskManager::SetUpRing(size_t queue_depth) -> bool {
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  auto *ring = new Ring();
+  ring->fd_ = syscall(__NR_io_uring_setup, static_cast<unsigned>(queue_depth), &params);
+  if (ring->fd_ < 0) {
+    LOG_DEBUG("io_uring is not available, falling back to a thread pool");
+    delete ring;
+    return false;
+  }
+  ring->sq_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  ring->cq_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single_mmap) {
+    ring->sq_size_ = ring->cq_size_ = std::max(ring->sq_size_, ring->cq_size_);
+  }
+  ring->sq_ptr_ =
+      mmap(nullptr, ring->sq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd_, IORING_OFF_SQ_RING);
+  ring->cq_ptr_ = single_mmap ? ring->sq_ptr_
+                              : mmap(nullptr, ring->cq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                     ring->fd_, IORING_OFF_CQ_RING);
+  ring->sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  ring->sqes_ =
+      mmap(nullptr, ring->sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd_, IORING_OFF_SQES);
+  if (ring->sq_ptr_ == MAP_FAILED || ring->cq_ptr_ == MAP_FAILED || ring->sqes_ == MAP_FAILED) {
+    LOG_DEBUG("can't map the io_uring queues, falling back to a thread pool");
+    delete ring;
+    return false;
+  }
+
+  auto *sq = static_cast<char *>(ring->sq_ptr_);
+  ring->sq_head_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+  ring->sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+  ring->sq_mask_ = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+  ring->sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+  ring->sqe_array_ = static_cast<io_uring_sqe *>(ring->sqes_);
+  ring->sq_entries_ = params.sq_entries;
+
+  auto *cq = static_cast<char *>(ring->cq_ptr_);
+  ring->cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+  ring->cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+  ring->cq_mask_ = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+  ring->cqe_array_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+  ring_ = ring;
+  return true;
+}
+
+void AsyncDiskManager::SubmitToRing(Request *request) {
+  auto lock = std::unique_lock(submit_latch_);
+  // The completion queue holds twice as many entries as the submission queue, so with at most sq_entries_ requests in
+  // flight it can never overflow. The null request of the shut down does not count.
+  if (request != nullptr) {
+    slot_cv_.wait(lock, [&] { return num_in_flight_ < ring_->sq_entries_; });
+    num_in_flight_++;
+  }
+
+  unsigned tail = *ring_->sq_tail_;
+  unsigned index = tail & ring_->sq_mask_;
+  io_uring_sqe *sqe = &ring_->sqe_array_[index];
+  memset(sqe, 0, sizeof(*sqe));
+  if (request == nullptr) {
+    // Drained: it only completes after every request submitted before it.
+    sqe->opcode = IORING_OP_NOP;
+    sqe->flags = IOSQE_IO_DRAIN;
+  } else {
+    request->iov_.iov_base = request->bounce_ != nullptr ? request->bounce_ : request->data_;
+    request->iov_.iov_len = PAGE_SIZE;
+    sqe->opcode = request->is_write_ ? IORING_OP_WRITEV : IORING_OP_READV;
+    sqe->fd = GetDataFile(request->page_id_).fd_;
+    sqe->off = GetFileOffset(request->page_id_);
+    sqe->addr = reinterpret_cast<uint64_t>(&request->iov_);
+    sqe->len = 1;
+  }
+  sqe->user_data = reinterpret_cast<uint64_t>(request);
+  ring_->sq_array_[index] = index;
+  __atomic_store_n(ring_->sq_tail_, tail + 1, __ATOMIC_RELEASE);
+
+  // Submit everything the kernel has not consumed yet, including entries left over by an earlier failed attempt.
+  while (true) {
+    unsigned to_submit = tail + 1 - __atomic_load_n(ring_->sq_head_, __ATOMIC_ACQUIRE);
+    if (to_submit == 0 || ring_->Enter(to_submit, 0, 0) >= 0) {
+      break;
+    }
+    if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+      LOG_DEBUG("I/O error while submitting to io_uring");
+      break;
+    }
+  }
+}
+
+void AsyncDiskManager::CompletionLoop() {
+  while (true) {
+    unsigned head = *ring_->cq_head_;
+    if (head == __atomic_load_n(ring_->cq_tail_, __ATOMIC_ACQUIRE)) {
+      ring_->Enter(0, 1, IORING_ENTER_GETEVENTS);
+      continue;
+    }
+    io_uring_cqe *cqe = &ring_->cqe_array_[head & ring_->cq_mask_];
+    auto *request = reinterpret_cast<Request *>(cqe->user_data);
+    int result = cqe->res;
+    __atomic_store_n(ring_->cq_head_, head + 1, __ATOMIC_RELEASE);
+    if (request == nullptr) {
+      return;
+    }
+    Complete(request, result);
+    {
+      auto lock = std::lock_guard(submit_latch_);
+      num_in_flight_--;
+    }
+    slot_cv_.notify_one();
+  }
+}
+
+#else
+
+auto AsyncDiskManager::SetUpRing(size_t queue_depth) -> bool { return false; }
+
+void AsyncDiskManager::SubmitToRing(Request *request) { UNREACHABLE("io_uring is not available"); }
+
+void AsyncDiskManager::CompletionLoop() {}
+
+#endif
+
+void AsyncDiskManager::WorkerLoop() {
+  while (true) {
+    auto lock = std::unique_lock(queue_latch_);
+    queue_cv_.wait(lock, [&] { return stopping_ || !queue_.empty(); });
+    if (queue_.empty()) {
+      return;
+    }
+    Request *request = queue_.front();
+    queue_.pop_front();
+    lock.unlock();
+    Complete(request, 0);
+  }
+}
+
+}  // namespace bustub
@@ -10,28 +10,105 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>  // NOLINT
+#include <climits>
 #include <cassert>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
 #include <mutex>  // NOLINT
+#include <numeric>
 #include <string>
 #include <thread>  // NOLINT
+#include <utility>
 
 #include "common/exception.h"
 #include "common/logger.h"
+#include "common/macros.h"
+#include "common/util/crc32c_util.h"
 #include "storage/disk/disk_manager.h"
 
 namespace bustub {
 
 static char *buffer_used;
 
+namespace {
+
+/** Page-aligned buffer through which a thread copies unaligned pages in direct I/O mode. */
+class BounceBuffer {
+ public:
+  BounceBuffer() : data_(static_cast<char *>(std::aligned_alloc(PAGE_SIZE, PAGE_SIZE))) {}
+  ~BounceBuffer() { free(data_); }
+  char *data_;
+};
+
+auto GetBounceBuffer() -> char * {
+  thread_local BounceBuffer buffer;
+  return buffer.data_;
+}
+
+/** Identifies a free page bitmap file: "BTFS" followed by the format version. */
+constexpr uint32_t FREE_PAGES_FILE_MAGIC = 0x42544653;
+constexpr uint32_t FREE_PAGES_FILE_VERSION = 1;
+
+/** @return false on an I/O error */
+auto WriteAll(int fd, const void *data, size_t size) -> bool {
+  const char *begin = static_cast<const char *>(data);
+  size_t written = 0;
+  while (written < size) {
+    ssize_t n = write(fd, begin + written, size - written);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    written += n;
+  }
+  return true;
+}
+
+/** @return false on an I/O error or if the file ends first */
+auto ReadAll(int fd, void *data, size_t size) -> bool {
+  char *begin = static_cast<char *>(data);
+  size_t read_count = 0;
+  while (read_count < size) {
+    ssize_t n = read(fd, begin + read_count, size - read_count);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    read_count += n;
+  }
+  return true;
+}
+
+}  // namespace
+
 /**
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
  */
-DiskManager::DiskManager(const std::string &db_file)
-    : file_name_(db_file), num_flushes_(0), num_writes_(0), flush_log_(false), flush_log_f_(nullptr) {
+DiskManager::DiskManager(const std::string &db_file, DiskWriteMode write_mode, DiskIOMode io_mode,
+                         const std::vector<std::string> &stripe_dirs)
+    : num_writes_(0),
+      file_name_(db_file),
+      num_flushes_(0),
+      write_mode_(write_mode),
+      io_mode_(io_mode),
+      flush_log_(false),
+      flush_log_f_(nullptr),
+      num_pages_(0) {
   std::string::size_type n = file_name_.rfind('.');
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
@@ -52,31 +129,68 @@ DiskManager::DiskManager(const std::string &db_file)
       throw Exception("can't open dblog file");
     }
   }
+  log_fd_ = open(log_name_.c_str(), O_RDONLY);
 
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out);
-    db_io_.close();
-    // reopen with original mode
-    db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-    if (!db_io_.is_open()) {
-      throw Exception("can't open db file");
+  // stripe i of a db file dir/name.ext is stripe_dir/name.i.ext
+  std::vector<std::string> file_names{db_file};
+  const std::string::size_type base = file_name_.rfind('/', n);
+  const std::string stem = file_name_.substr(base == std::string::npos ? 0 : base + 1, n - (base + 1));
+  for (size_t i = 0; i < stripe_dirs.size(); i++) {
+    file_names.push_back(stripe_dirs[i] + "/" + stem + "." + std::to_string(i + 1) + file_name_.substr(n));
+  }
+  OpenDataFiles(file_names);
+
+  // The logical extent ends after the last page of whichever file holds it.
+  page_id_t num_pages = 0;
+  for (size_t i = 0; i < data_files_.size(); i++) {
+    const size_t file_pages = (data_files_[i]->size_ + PAGE_SIZE - 1) / PAGE_SIZE;
+    if (file_pages > 0) {
+      const size_t last = file_pages - 1;
+      const size_t stripe = last / STRIPE_NUM_PAGES * data_files_.size() + i;
+      num_pages = std::max(num_pages, static_cast<page_id_t>(stripe * STRIPE_NUM_PAGES + last % STRIPE_NUM_PAGES + 1));
     }
   }
+  num_pages_ = num_pages;
   buffer_used = nullptr;
+
+  free_pages_name_ = file_name_.substr(0, n) + ".fsm";
+  LoadFreePages();
+}
+
+DiskManager::~DiskManager() {
+  UnmapDataFiles();
+  for (auto &file : data_files_) {
+    if (file->fd_ >= 0) {
+      close(file->fd_);
+    }
+  }
+  if (log_fd_ >= 0) {
+    close(log_fd_);
+  }
 }
 
 /**
  * Close all file streams
  */
 void DiskManager::ShutDown() {
+  UnmapDataFiles();
   {
-    std::scoped_lock scoped_db_io_latch(db_io_latch_);
-    db_io_.close();
+    auto lock = std::lock_guard(free_pages_latch_);
+    // Like Sync, only persist deallocations once the writes that freed the pages are durable.
+    if (free_pages_dirty_ && data_files_[0]->fd_ >= 0 && SyncDataFiles()) {
+      SaveFreePages(free_pages_);
+      free_pages_dirty_ = false;
+    }
+  }
+  for (auto &file : data_files_) {
+    if (file->fd_ >= 0) {
+      close(file->fd_);
+      file->fd_ = -1;
+    }
+  }
+  if (log_fd_ >= 0) {
+    close(log_fd_);
+    log_fd_ = -1;
   }
   log_io_.close();
 }
@@ -85,48 +199,529 @@ void DiskManager::ShutDown() {
  * Write the contents of the specified page into disk file
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  size_t offset = static_cast<size_t>(page_id) * PAGE_SIZE;
-  // set write cursor to offset
   num_writes_ += 1;
-  db_io_.seekp(offset);
-  db_io_.write(page_data, PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
-    LOG_DEBUG("I/O error while writing");
-    return;
+  const auto start = std::chrono::steady_clock::now();
+  bool written = WriteFrom(page_id, page_data, 0);
+  RecordLatency(IOOperation::WRITE_PAGE, IOCategoryScope::Current(), start);
+  if (written) {
+    EndWrite(page_id);
+  }
+}
+
+auto DiskManager::WriteFrom(page_id_t page_id, const char *page_data, size_t written) -> bool {
+  char *buffer = GetBounceBuffer();
+  if (written < PAGE_SIZE && page_data != buffer && NeedsCopyForWrite(page_data)) {
+    memcpy(buffer, page_data, PAGE_SIZE);
+    StampChecksum(page_id, buffer);
+    return WriteFrom(page_id, buffer, written);
+  }
+  const int fd = GetDataFile(page_id).fd_;
+  const size_t offset = GetFileOffset(page_id);
+  while (written < PAGE_SIZE) {
+    num_write_calls_ += 1;
+    ssize_t n = pwrite(fd, page_data + written, PAGE_SIZE - written, offset + written);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    // check for I/O error
+    if (n <= 0) {
+      LOG_DEBUG("I/O error while writing");
+      return false;
+    }
+    written += n;
+  }
+  return true;
+}
+
+void DiskManager::EndWrite(page_id_t page_id) {
+  ExtendFile(page_id);
+  if (write_mode_ == DiskWriteMode::WRITE_THROUGH) {
+    Sync();
+  }
+}
+
+void DiskManager::ExtendFile(page_id_t page_id) {
+  auto &file_size = GetDataFile(page_id).size_;
+  const size_t end = GetFileOffset(page_id) + PAGE_SIZE;
+  size_t size = file_size;
+  while (end > size && !file_size.compare_exchange_weak(size, end)) {
+  }
+  AllocatePage(page_id);
+}
+
+auto DiskManager::GetDbFileSize() const -> size_t {
+  size_t size = 0;
+  for (const auto &file : data_files_) {
+    size += file->size_;
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
+  return size;
+}
+
+/**
+ * Write the contents of the specified pages, coalescing runs of consecutive pages
+ */
+void DiskManager::WritePages(const std::vector<page_id_t> &page_ids, const std::vector<const char *> &page_data) {
+  BUSTUB_ASSERT(page_ids.size() == page_data.size(), "Every page needs its data");
+  std::vector<size_t> order(page_ids.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&page_ids](size_t a, size_t b) { return page_ids[a] < page_ids[b]; });
+  std::vector<page_id_t> sorted_page_ids;
+  std::vector<const char *> sorted_page_data;
+  sorted_page_ids.reserve(order.size());
+  sorted_page_data.reserve(order.size());
+  for (size_t i : order) {
+    sorted_page_ids.push_back(page_ids[i]);
+    sorted_page_data.push_back(page_data[i]);
+  }
+
+  num_writes_ += page_ids.size();
+  size_t begin = 0;
+  while (begin < sorted_page_ids.size()) {
+    size_t end = begin + 1;
+    // A run stops at the end of a stripe unless every page is in the db file.
+    while (end < sorted_page_ids.size() && end - begin < IOV_MAX &&
+           sorted_page_ids[end] == sorted_page_ids[end - 1] + 1 &&
+           (data_files_.size() == 1 || sorted_page_ids[end] % STRIPE_NUM_PAGES != 0)) {
+      end++;
+    }
+    WriteRun(&sorted_page_ids[begin], &sorted_page_data[begin], end - begin);
+    begin = end;
+  }
+  if (!page_ids.empty() && write_mode_ == DiskWriteMode::WRITE_THROUGH) {
+    Sync();
+  }
+}
+
+auto DiskManager::WriteRun(const page_id_t *page_ids, const char *const *page_data, size_t num_pages) -> bool {
+  std::vector<struct iovec> iov(num_pages);
+  std::vector<char *> bounces;
+  for (size_t i = 0; i < num_pages; i++) {
+    char *data = const_cast<char *>(page_data[i]);
+    if (NeedsCopyForWrite(data)) {
+      bounces.push_back(static_cast<char *>(std::aligned_alloc(PAGE_SIZE, PAGE_SIZE)));
+      memcpy(bounces.back(), data, PAGE_SIZE);
+      StampChecksum(page_ids[i], bounces.back());
+      data = bounces.back();
+    }
+    iov[i].iov_base = data;
+    iov[i].iov_len = PAGE_SIZE;
+  }
+  const auto start = std::chrono::steady_clock::now();
+  ssize_t n;
+  do {
+    num_write_calls_ += 1;
+    n = pwritev(GetDataFile(page_ids[0]).fd_, iov.data(), static_cast<int>(num_pages),
+                static_cast<off_t>(GetFileOffset(page_ids[0])));
+  } while (n < 0 && errno == EINTR);
+
+  // A short or failed vectored write is finished page by page from the same copies, which also reports the error.
+  const size_t written = std::max<ssize_t>(n, 0);
+  bool success = true;
+  for (size_t i = 0; i < num_pages; i++) {
+    const size_t page_written = std::min<size_t>(PAGE_SIZE, written - std::min(written, i * PAGE_SIZE));
+    if (page_written < PAGE_SIZE && !WriteFrom(page_ids[i], static_cast<const char *>(iov[i].iov_base), page_written)) {
+      success = false;
+    }
+  }
+  for (char *bounce : bounces) {
+    free(bounce);
+  }
+  RecordLatency(IOOperation::WRITE_PAGE, IOCategoryScope::Current(), start);
+  if (success) {
+    ExtendFile(page_ids[num_pages - 1]);
+  }
+  return success;
+}
+
+/**
+ * Make every page written so far durable
+ */
+void DiskManager::Sync() {
+  num_syncs_ += 1;
+  const auto start = std::chrono::steady_clock::now();
+  const bool synced = SyncDataFiles();
+  RecordLatency(IOOperation::SYNC, IOCategoryScope::Current(), start);
+  // Deallocated pages are only reused after a crash once the pages that referred to them are durable.
+  auto lock = std::lock_guard(free_pages_latch_);
+  if (free_pages_dirty_ && synced) {
+    SaveFreePages(free_pages_);
+    durable_free_pages_ = free_pages_;
+    free_pages_dirty_ = false;
+  }
+}
+
+auto DiskManager::SyncDataFiles() -> bool {
+  bool synced = true;
+  for (auto &file : data_files_) {
+    if (fdatasync(file->fd_) != 0) {
+      LOG_DEBUG("I/O error while syncing %s", file->name_.c_str());
+      synced = false;
+    }
+  }
+  return synced;
+}
+
+/**
+ * Make every log record written so far durable
+ */
+void DiskManager::SyncLog() {
+  num_syncs_ += 1;
+  const auto start = std::chrono::steady_clock::now();
+  if (log_fd_ < 0 || fdatasync(log_fd_) != 0) {
+    LOG_DEBUG("I/O error while syncing log");
+  }
+  RecordLatency(IOOperation::SYNC, IOCategory::WAL, start);
 }
 
 /**
  * Read the contents of the specified page into the given memory area
  */
-void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  int offset = page_id * PAGE_SIZE;
+auto DiskManager::ReadPage(page_id_t page_id, char *page_data) -> bool {
+  bool from_file = false;
+  if (!BeginRead(page_id, page_data, &from_file)) {
+    return false;
+  }
+  if (!from_file) {
+    return true;
+  }
+  const auto start = std::chrono::steady_clock::now();
+  ssize_t read_count = ReadFrom(page_id, page_data, 0);
+  RecordLatency(IOOperation::READ_PAGE, IOCategoryScope::Current(), start);
+  return read_count >= 0 && EndRead(page_id, page_data, read_count);
+}
+
+auto DiskManager::BeginRead(page_id_t page_id, char *page_data, bool *from_file) -> bool {
+  *from_file = false;
   // check if read beyond file length
-  if (offset > GetFileSize(file_name_)) {
+  if (page_id >= num_pages_) {
     LOG_DEBUG("I/O error reading past end of file");
-    // std::cerr << "I/O error while reading" << std::endl;
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, PAGE_SIZE);
-    if (db_io_.bad()) {
+    return false;
+  }
+  if (GetFileOffset(page_id) >= GetDataFile(page_id).size_) {
+    // allocated, but not written yet
+    memset(page_data, 0, PAGE_SIZE);
+    return true;
+  }
+  *from_file = true;
+  return true;
+}
+
+auto DiskManager::ReadFrom(page_id_t page_id, char *page_data, size_t read_count) -> ssize_t {
+  if (NeedsBounce(page_data)) {
+    char *buffer = GetBounceBuffer();
+    ssize_t total = ReadFrom(page_id, buffer, read_count);
+    if (total > static_cast<ssize_t>(read_count)) {
+      memcpy(page_data + read_count, buffer + read_count, total - read_count);
+    }
+    return total;
+  }
+  const int fd = GetDataFile(page_id).fd_;
+  const size_t offset = GetFileOffset(page_id);
+  while (read_count < PAGE_SIZE) {
+    ssize_t n = pread(fd, page_data + read_count, PAGE_SIZE - read_count, offset + read_count);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n < 0) {
       LOG_DEBUG("I/O error while reading");
+      return -1;
+    }
+    if (n == 0) {
+      break;
+    }
+    read_count += n;
+  }
+  return read_count;
+}
+
+auto DiskManager::EndRead(page_id_t page_id, char *page_data, size_t read_count) -> bool {
+  // if file ends before reading PAGE_SIZE
+  if (read_count < PAGE_SIZE) {
+    LOG_DEBUG("Read less than a page");
+    memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+  }
+  if (!page_checksums_) {
+    return true;
+  }
+  uint32_t stored;
+  memcpy(&stored, page_data + PAGE_CONTENT_SIZE, sizeof(stored));
+  if (stored == ComputePageChecksum(page_id, page_data)) {
+    return true;
+  }
+  // A hole in the file reads as zeros without a checksum.
+  if (stored == 0 && std::all_of(page_data, page_data + PAGE_CONTENT_SIZE, [](char c) { return c == 0; })) {
+    return true;
+  }
+  num_checksum_failures_ += 1;
+  LOG_WARN("checksum mismatch while reading page %d", page_id);
+  return false;
+}
+
+/**
+ * Checksum the page content, seeded with the page id so that a page written to the wrong place fails verification
+ */
+auto DiskManager::ComputePageChecksum(page_id_t page_id, const char *page_data) -> uint32_t {
+  uint32_t crc = Crc32cUtil::Crc32c(reinterpret_cast<const char *>(&page_id), sizeof(page_id));
+  return Crc32cUtil::Crc32c(page_data, PAGE_CONTENT_SIZE, crc);
+}
+
+void DiskManager::StampChecksum(page_id_t page_id, char *page_data) const {
+  if (page_checksums_) {
+    uint32_t crc = ComputePageChecksum(page_id, page_data);
+    memcpy(page_data + PAGE_CONTENT_SIZE, &crc, sizeof(crc));
+  }
+}
+
+/**
+ * Read the contents of the specified pages, sorted by their position in the file
+ */
+auto DiskManager::ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &page_data)
+    -> std::vector<bool> {
+  BUSTUB_ASSERT(page_ids.size() == page_data.size(), "Every page needs an output buffer");
+  std::vector<size_t> order(page_ids.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&page_ids](size_t a, size_t b) { return page_ids[a] < page_ids[b]; });
+  std::vector<bool> read(page_ids.size());
+  for (size_t i : order) {
+    read[i] = ReadPage(page_ids[i], page_data[i]);
+  }
+  return read;
+}
+
+/**
+ * Extend the logical file extent to cover the specified page
+ */
+void DiskManager::AllocatePage(page_id_t page_id) {
+  Preallocate(page_id);
+  page_id_t num_pages = num_pages_;
+  while (page_id >= num_pages && !num_pages_.compare_exchange_weak(num_pages, page_id + 1)) {
+  }
+}
+
+/**
+ * Reserve extents of geometrically growing size ahead of the pages in use
+ */
+void DiskManager::Preallocate(page_id_t page_id) {
+  DataFile &file = GetDataFile(page_id);
+  const size_t end = GetFileOffset(page_id) + PAGE_SIZE;
+  if (!preallocate_ || end <= file.preallocate_at_) {
+    return;
+  }
+  auto lock = std::lock_guard(file.preallocate_latch_);
+  while (end > file.preallocate_at_) {
+    const size_t offset = std::max<size_t>(file.preallocated_, file.size_);
+    // The file size stays as it is, so the logical extent is still recovered from the pages written.
+    if (fallocate(file.fd_, FALLOC_FL_KEEP_SIZE, offset, file.extent_size_) != 0) {
+      LOG_DEBUG("can't preallocate %s, growing it page by page", file.name_.c_str());
+      file.preallocate_at_ = SIZE_MAX;
       return;
     }
-    // if file ends before reading PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < PAGE_SIZE) {
-      LOG_DEBUG("Read less than a page");
-      db_io_.clear();
-      // std::cerr << "Read less than a page" << std::endl;
-      memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+    num_preallocations_ += 1;
+    file.preallocated_ = offset + file.extent_size_;
+    file.preallocate_at_ = file.preallocated_ - file.extent_size_ / 4;
+    file.extent_size_ = std::min(file.extent_size_ * 2, PREALLOCATE_MAX_SIZE);
+  }
+}
+
+/**
+ * Map every data file read-only, up to the size it has been written to
+ */
+auto DiskManager::MapDataFiles() -> bool {
+  UnmapDataFiles();
+  for (auto &file : data_files_) {
+    if (file->size_ == 0) {
+      continue;
+    }
+    void *mapping = mmap(nullptr, file->size_, PROT_READ, MAP_SHARED, file->fd_, 0);
+    if (mapping == MAP_FAILED) {
+      LOG_DEBUG("can't map %s", file->name_.c_str());
+      UnmapDataFiles();
+      return false;
+    }
+    file->mapping_ = static_cast<char *>(mapping);
+    file->mapping_size_ = file->size_;
+  }
+  return true;
+}
+
+void DiskManager::UnmapDataFiles() {
+  for (auto &file : data_files_) {
+    if (file->mapping_ != nullptr) {
+      munmap(file->mapping_, file->mapping_size_);
+      file->mapping_ = nullptr;
+      file->mapping_size_ = 0;
+    }
+  }
+}
+
+auto DiskManager::GetMappedPage(page_id_t page_id) const -> const char * {
+  if (page_id < 0 || page_id >= num_pages_) {
+    return nullptr;
+  }
+  const DataFile &file = GetDataFile(page_id);
+  const size_t offset = GetFileOffset(page_id);
+  if (file.mapping_ == nullptr || offset + PAGE_SIZE > file.mapping_size_) {
+    return nullptr;
+  }
+  return file.mapping_ + offset;
+}
+
+/**
+ * Pass the access pattern on to the kernel, one contiguous range of a data file at a time
+ */
+void DiskManager::AdviseMappedPages(page_id_t page_id, size_t num_pages, MappedAccess access) {
+  int advice = MADV_NORMAL;
+  switch (access) {
+    case MappedAccess::SEQUENTIAL:
+      advice = MADV_SEQUENTIAL;
+      break;
+    case MappedAccess::WILL_NEED:
+      advice = MADV_WILLNEED;
+      break;
+    case MappedAccess::NORMAL:
+      break;
+  }
+  const auto extent = static_cast<size_t>(num_pages_.load());
+  if (page_id < 0 || static_cast<size_t>(page_id) >= extent) {
+    return;
+  }
+  // Clamp before adding, so that a count meaning "to the end" cannot wrap around.
+  const size_t end = page_id + std::min(num_pages, extent - page_id);
+  size_t begin = page_id;
+  while (begin < end) {
+    // Consecutive pages are contiguous in a data file up to the end of their stripe.
+    size_t run_end = end;
+    if (data_files_.size() > 1) {
+      run_end = std::min(end, (begin / STRIPE_NUM_PAGES + 1) * STRIPE_NUM_PAGES);
+    }
+    const DataFile &file = GetDataFile(begin);
+    const size_t offset = GetFileOffset(begin);
+    if (file.mapping_ != nullptr && offset < file.mapping_size_) {
+      const size_t length = std::min((run_end - begin) * PAGE_SIZE, file.mapping_size_ - offset);
+      madvise(file.mapping_ + offset, length, advice);
+      num_advised_pages_ += (length + PAGE_SIZE - 1) / PAGE_SIZE;
+    }
+    begin = run_end;
+  }
+}
+
+/**
+ * Mark the specified page as free
+ */
+void DiskManager::DeallocatePage(page_id_t page_id) {
+  if (page_id < 0 || page_id >= num_pages_) {
+    LOG_DEBUG("deallocating a page past the end of file");
+    return;
+  }
+  const size_t word = page_id / 64;
+  const uint64_t mask = uint64_t{1} << (page_id % 64);
+  auto lock = std::lock_guard(free_pages_latch_);
+  if (word >= free_pages_.size()) {
+    free_pages_.resize(word + 1);
+  }
+  if ((free_pages_[word] & mask) == 0) {
+    free_pages_[word] |= mask;
+    num_free_pages_ += 1;
+    free_pages_dirty_ = true;
+  }
+}
+
+/**
+ * Claim up to max_pages free pages of the specified instance, lowest page ids first
+ */
+auto DiskManager::AllocateFreePages(uint32_t num_instances, uint32_t instance_index, size_t max_pages)
+    -> std::vector<page_id_t> {
+  std::vector<page_id_t> page_ids;
+  if (num_free_pages_ == 0) {
+    return page_ids;
+  }
+  auto lock = std::lock_guard(free_pages_latch_);
+  bool durable_changed = false;
+  for (size_t word = 0; word < free_pages_.size() && page_ids.size() < max_pages; word++) {
+    for (uint64_t bits = free_pages_[word]; bits != 0 && page_ids.size() < max_pages; bits &= bits - 1) {
+      const auto page_id = static_cast<page_id_t>(word * 64 + __builtin_ctzll(bits));
+      if (page_id % num_instances != instance_index) {
+        continue;
+      }
+      const uint64_t mask = uint64_t{1} << (page_id % 64);
+      free_pages_[word] &= ~mask;
+      if (word < durable_free_pages_.size() && (durable_free_pages_[word] & mask) != 0) {
+        durable_free_pages_[word] &= ~mask;
+        durable_changed = true;
+      }
+      page_ids.push_back(page_id);
     }
   }
+  num_free_pages_ -= page_ids.size();
+  // A page that is free in the persisted bitmap must not be handed out again after a crash.
+  if (durable_changed) {
+    SaveFreePages(durable_free_pages_);
+  }
+  return page_ids;
+}
+
+void DiskManager::LoadFreePages() {
+  int fd = open(free_pages_name_.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return;
+  }
+  uint32_t header[2];
+  uint64_t num_words = 0;
+  bool valid = ReadAll(fd, header, sizeof(header)) && header[0] == FREE_PAGES_FILE_MAGIC &&
+               header[1] == FREE_PAGES_FILE_VERSION && ReadAll(fd, &num_words, sizeof(num_words));
+  std::vector<uint64_t> bitmap;
+  if (valid) {
+    bitmap.resize(num_words);
+    valid = ReadAll(fd, bitmap.data(), num_words * sizeof(uint64_t));
+  }
+  close(fd);
+  if (!valid) {
+    LOG_DEBUG("ignoring invalid free page file %s", free_pages_name_.c_str());
+    return;
+  }
+  // Pages past the end of the file are not free, they do not exist; the file may have been replaced.
+  const size_t num_pages = num_pages_;
+  bitmap.resize(std::min<size_t>(bitmap.size(), (num_pages + 63) / 64));
+  if (num_pages % 64 != 0 && bitmap.size() == (num_pages + 63) / 64) {
+    bitmap.back() &= (uint64_t{1} << (num_pages % 64)) - 1;
+  }
+  size_t num_free_pages = 0;
+  for (uint64_t bits : bitmap) {
+    num_free_pages += __builtin_popcountll(bits);
+  }
+  free_pages_ = bitmap;
+  durable_free_pages_ = std::move(bitmap);
+  num_free_pages_ = num_free_pages;
+}
+
+void DiskManager::SaveFreePages(const std::vector<uint64_t> &bitmap) {
+  const std::string tmp_name = free_pages_name_ + ".tmp";
+  int fd = open(tmp_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    LOG_DEBUG("can't open free page file %s", tmp_name.c_str());
+    return;
+  }
+  const uint32_t header[2] = {FREE_PAGES_FILE_MAGIC, FREE_PAGES_FILE_VERSION};
+  const uint64_t num_words = bitmap.size();
+  bool saved = WriteAll(fd, header, sizeof(header)) && WriteAll(fd, &num_words, sizeof(num_words)) &&
+               WriteAll(fd, bitmap.data(), num_words * sizeof(uint64_t)) && fdatasync(fd) == 0;
+  close(fd);
+  // A crash while saving leaves the previous bitmap intact.
+  if (!saved || rename(tmp_name.c_str(), free_pages_name_.c_str()) != 0) {
+    LOG_DEBUG("I/O error while saving free page file %s", free_pages_name_.c_str());
+    remove(tmp_name.c_str());
+    return;
+  }
+  // The rename itself is only durable once the directory is synced.
+  const size_t slash = free_pages_name_.rfind('/');
+  const std::string dir_name = slash == std::string::npos ? "." : free_pages_name_.substr(0, slash + 1);
+  int dir_fd = open(dir_name.c_str(), O_RDONLY | O_DIRECTORY);
+  if (dir_fd < 0 || fsync(dir_fd) != 0) {
+    LOG_DEBUG("I/O error while syncing the directory of %s", free_pages_name_.c_str());
+  }
+  if (dir_fd >= 0) {
+    close(dir_fd);
+  }
 }
 
 /**
@@ -150,6 +745,7 @@ void DiskManager::WriteLog(char *log_data, int size) {
   }
 
   num_flushes_ += 1;
+  const auto start = std::chrono::steady_clock::now();
   // sequence write
   log_io_.write(log_data, size);
 
@@ -158,8 +754,12 @@ void DiskManager::WriteLog(char *log_data, int size) {
     LOG_DEBUG("I/O error while writing log");
     return;
   }
-  // needs to flush to keep disk file in sync
+  // hand the records to the OS; they are durable once synced
   log_io_.flush();
+  RecordLatency(IOOperation::WRITE_LOG, IOCategory::WAL, start);
+  if (write_mode_ == DiskWriteMode::WRITE_THROUGH) {
+    SyncLog();
+  }
   flush_log_ = false;
 }
 
@@ -191,6 +791,25 @@ auto DiskManager::ReadLog(char *log_data, int size, int offset) -> bool {
   return true;
 }
 
+/**
+ * Snapshot the latency histograms
+ */
+auto DiskManager::GetIOStats() const -> DiskIOStats {
+  DiskIOStats stats;
+  for (size_t i = 0; i < NUM_IO_OPERATIONS; i++) {
+    for (size_t j = 0; j < NUM_IO_CATEGORIES; j++) {
+      stats.latencies_[i][j] = latencies_[i * NUM_IO_CATEGORIES + j].Snapshot();
+    }
+  }
+  return stats;
+}
+
+void DiskManager::ResetIOStats() {
+  for (auto &latency : latencies_) {
+    latency.Reset();
+  }
+}
+
 /**
  * Returns number of flushes made so far
  */
@@ -206,6 +825,39 @@ auto DiskManager::GetNumWrites() const -> int { return num_writes_; }
  */
 auto DiskManager::GetFlushState() const -> bool { return flush_log_; }
 
+/**
+ * Private helper function to open the data files, all with the same I/O mode
+ */
+void DiskManager::OpenDataFiles(const std::vector<std::string> &file_names) {
+  const int flags = O_RDWR | O_CREAT | (io_mode_ == DiskIOMode::DIRECT ? O_DIRECT : 0);
+  for (const auto &file_name : file_names) {
+    auto file = std::make_unique<DataFile>();
+    file->name_ = file_name;
+    // create the file if it does not exist
+    file->fd_ = open(file_name.c_str(), flags, 0644);
+    if (file->fd_ < 0 && io_mode_ == DiskIOMode::DIRECT && errno == EINVAL) {
+      LOG_DEBUG("direct I/O is not supported, falling back to buffered I/O");
+      for (auto &opened : data_files_) {
+        close(opened->fd_);
+      }
+      data_files_.clear();
+      io_mode_ = DiskIOMode::BUFFERED;
+      OpenDataFiles(file_names);
+      return;
+    }
+    if (file->fd_ < 0) {
+      throw Exception("can't open db file");
+    }
+    struct stat stat_buf;
+    if (fstat(file->fd_, &stat_buf) != 0) {
+      close(file->fd_);
+      throw Exception("can't stat db file");
+    }
+    file->size_ = stat_buf.st_size;
+    data_files_.push_back(std::move(file));
+  }
+}
+
 /**
  * Private helper function to get disk file size
  */
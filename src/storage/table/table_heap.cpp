@@ -31,13 +31,13 @@ TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_m
   auto first_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(&first_page_id_));
   BUSTUB_ASSERT(first_page != nullptr, "Couldn't create a page for the table heap.");
   first_page->WLatch();
-  first_page->Init(first_page_id_, PAGE_SIZE, INVALID_LSN, log_manager_, txn);
+  first_page->Init(first_page_id_, PAGE_CONTENT_SIZE, INVALID_LSN, log_manager_, txn);
   first_page->WUnlatch();
   buffer_pool_manager_->UnpinPage(first_page_id_, true);
 }
 
 auto TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) -> bool {
-  if (tuple.size_ + 32 > PAGE_SIZE) {  // larger than one page size
+  if (tuple.size_ + 32 > PAGE_CONTENT_SIZE) {  // larger than one page size
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
@@ -75,7 +75,7 @@ auto TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) -> b
       // Otherwise we were able to create a new page. We initialize it now.
       new_page->WLatch();
       cur_page->SetNextPageId(next_page_id);
-      new_page->Init(next_page_id, PAGE_SIZE, cur_page->GetTablePageId(), log_manager_, txn);
+      new_page->Init(next_page_id, PAGE_CONTENT_SIZE, cur_page->GetTablePageId(), log_manager_, txn);
       cur_page->WUnlatch();
       buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
       cur_page = new_page;
@@ -154,6 +154,11 @@ void TableHeap::RollbackDelete(const RID &rid, Transaction *txn) {
 }
 
 auto TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn) -> bool {
+  // Read the tuple straight from the mapped page if mapped reads are on.
+  if (const char *data = buffer_pool_manager_->GetMappedPage(rid.GetPageId()); data != nullptr) {
+    Page view(data, Page::ViewTag{});
+    return static_cast<TablePage *>(&view)->GetTuple(rid, tuple, txn, lock_manager_);
+  }
   // Find the page which contains the tuple.
   auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
   // If the page could not be found, then abort the transaction.
@@ -169,24 +174,32 @@ auto TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn) -> bool
   return res;
 }
 
-auto TableHeap::Begin(Transaction *txn) -> TableIterator {
+auto TableHeap::Begin(Transaction *txn, BufferAccessStrategy *strategy) -> TableIterator {
   // Start an iterator from the first page.
   // TODO(Wuwen): Hacky fix for now. Removing empty pages is a better way to handle this.
   RID rid;
   auto page_id = first_page_id_;
   while (page_id != INVALID_PAGE_ID) {
-    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
-    page->RLatch();
-    // If this fails because there is no tuple, then RID will be the default-constructed value, which means EOF.
-    auto found_tuple = page->GetFirstTupleRid(&rid);
-    page->RUnlatch();
-    buffer_pool_manager_->UnpinPage(page_id, false);
+    bool found_tuple;
+    if (const char *data = buffer_pool_manager_->GetMappedPage(page_id); data != nullptr) {
+      Page view(data, Page::ViewTag{});
+      auto page = static_cast<TablePage *>(&view);
+      found_tuple = page->GetFirstTupleRid(&rid);
+      page_id = page->GetNextPageId();
+    } else {
+      auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id, strategy));
+      page->RLatch();
+      // If this fails because there is no tuple, then RID will be the default-constructed value, which means EOF.
+      found_tuple = page->GetFirstTupleRid(&rid);
+      page_id = page->GetNextPageId();
+      page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetTablePageId(), false);
+    }
     if (found_tuple) {
       break;
     }
-    page_id = page->GetNextPageId();
   }
-  return TableIterator(this, rid, txn);
+  return TableIterator(this, rid, txn, strategy);
 }
 
 auto TableHeap::End() -> TableIterator { return TableIterator(this, RID(INVALID_PAGE_ID, 0), nullptr); }
@@ -10,14 +10,16 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <cassert>
+#include <optional>
 
 #include "storage/table/table_heap.h"
 
 namespace bustub {
 
-TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn)
-    : table_heap_(table_heap), tuple_(new Tuple(rid)), txn_(txn) {
+TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn, BufferAccessStrategy *strategy)
+    : table_heap_(table_heap), tuple_(new Tuple(rid)), txn_(txn), strategy_(strategy) {
   if (rid.GetPageId() != INVALID_PAGE_ID) {
     table_heap_->GetTuple(tuple_->rid_, tuple_, txn_);
   }
@@ -34,20 +36,25 @@ auto TableIterator::operator->() -> Tuple * {
 }
 
 auto TableIterator::operator++() -> TableIterator & {
+  if (AdvanceMapped()) {
+    return *this;
+  }
   BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
-  auto cur_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(tuple_->rid_.GetPageId()));
+  auto cur_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(tuple_->rid_.GetPageId(), strategy_));
   cur_page->RLatch();
   assert(cur_page != nullptr);  // all pages are pinned
+  PrefetchNextPage(cur_page);
 
   RID next_tuple_rid;
   if (!cur_page->GetNextTupleRid(tuple_->rid_,
                                  &next_tuple_rid)) {  // end of this page
     while (cur_page->GetNextPageId() != INVALID_PAGE_ID) {
-      auto next_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(cur_page->GetNextPageId()));
+      auto next_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(cur_page->GetNextPageId(), strategy_));
       cur_page->RUnlatch();
       buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
       cur_page = next_page;
       cur_page->RLatch();
+      PrefetchNextPage(cur_page);
       if (cur_page->GetFirstTupleRid(&next_tuple_rid)) {
         break;
       }
@@ -64,6 +71,86 @@ auto TableIterator::operator++() -> TableIterator & {
   return *this;
 }
 
+auto TableIterator::AdvanceMapped() -> bool {
+  BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
+  const char *data = buffer_pool_manager->GetMappedPage(tuple_->rid_.GetPageId());
+  if (data == nullptr) {
+    return false;
+  }
+  std::optional<Page> view(std::in_place, data, Page::ViewTag{});
+  auto *cur_page = static_cast<TablePage *>(&*view);
+  PrefetchNextPage(cur_page);
+
+  RID next_tuple_rid;
+  if (!cur_page->GetNextTupleRid(tuple_->rid_, &next_tuple_rid)) {  // end of this page
+    while (cur_page->GetNextPageId() != INVALID_PAGE_ID) {
+      data = buffer_pool_manager->GetMappedPage(cur_page->GetNextPageId());
+      if (data == nullptr) {
+        // Written after the files were mapped: start over from the current tuple through the buffer pool.
+        return false;
+      }
+      view.emplace(data, Page::ViewTag{});
+      cur_page = static_cast<TablePage *>(&*view);
+      PrefetchNextPage(cur_page);
+      if (cur_page->GetFirstTupleRid(&next_tuple_rid)) {
+        break;
+      }
+    }
+  }
+  tuple_->rid_ = next_tuple_rid;
+
+  if (*this != table_heap_->End()) {
+    table_heap_->GetTuple(tuple_->rid_, tuple_, txn_);
+  } else {
+    EndReadAhead();
+  }
+  return true;
+}
+
+void TableIterator::PrefetchNextPage(TablePage *page) {
+  if (page->GetTablePageId() == prefetched_page_id_) {
+    return;
+  }
+  prefetched_page_id_ = page->GetTablePageId();
+  page_id_t next_page_id = page->GetNextPageId();
+  if (next_page_id == INVALID_PAGE_ID) {
+    return;
+  }
+  BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
+  if (buffer_pool_manager->GetMappedPage(next_page_id) != nullptr) {
+    // Mapped pages are read in by the kernel rather than into the buffer pool.
+    AdviseReadAhead(next_page_id);
+    buffer_pool_manager->AdviseMappedPages(next_page_id, 1, MappedAccess::WILL_NEED);
+  } else {
+    buffer_pool_manager->PrefetchPages({next_page_id}, strategy_);
+  }
+}
+
+void TableIterator::AdviseReadAhead(page_id_t page_id) {
+  const auto window = static_cast<page_id_t>(MAPPED_SCAN_WINDOW_PAGES);
+  if (read_ahead_begin_ != INVALID_PAGE_ID && page_id >= read_ahead_begin_ && page_id + window / 2 < read_ahead_end_) {
+    return;
+  }
+  table_heap_->buffer_pool_manager_->AdviseMappedPages(page_id, window, MappedAccess::SEQUENTIAL);
+  if (read_ahead_begin_ == INVALID_PAGE_ID) {
+    read_ahead_begin_ = page_id;
+    read_ahead_end_ = page_id + window;
+    return;
+  }
+  read_ahead_begin_ = std::min(read_ahead_begin_, page_id);
+  read_ahead_end_ = std::max(read_ahead_end_, page_id + window);
+}
+
+void TableIterator::EndReadAhead() {
+  if (read_ahead_begin_ == INVALID_PAGE_ID) {
+    return;
+  }
+  table_heap_->buffer_pool_manager_->AdviseMappedPages(read_ahead_begin_, read_ahead_end_ - read_ahead_begin_,
+                                                       MappedAccess::NORMAL);
+  read_ahead_begin_ = INVALID_PAGE_ID;
+  read_ahead_end_ = INVALID_PAGE_ID;
+}
+
 auto TableIterator::operator++(int) -> TableIterator {
   TableIterator clone(*this);
   ++(*this);
@@ -11,9 +11,15 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/buffer_pool_manager_instance.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <fstream>
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 #include "buffer/buffer_pool_manager.h"
 #include "gtest/gtest.h"
 
@@ -141,4 +147,815 @@ TEST(BufferPoolManagerInstanceTest, SampleTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, RingBufferTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const int num_scan_pages = 50;
+  const int num_hot_pages = 5;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (int i = 0; i < num_scan_pages; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    bpm->UnpinPage(page_id_temp, false);
+  }
+  // New pages are dirty until they are first written back.
+  bpm->FlushAllPages();
+  for (int i = 0; i < num_hot_pages; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "hot %d", page_id_temp);
+    bpm->UnpinPage(page_id_temp, true);
+  }
+
+  // Scenario: a bulk read of every page only recycles the two frames of its ring once they are filled,
+  // so the dirty hot pages are never evicted (and never written back).
+  int num_writes = disk_manager->GetNumWrites();
+  BufferAccessStrategy strategy(2);
+  for (int i = 0; i < num_scan_pages; ++i) {
+    auto *page = bpm->FetchPage(i, &strategy);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(i, page->GetPageId());
+    bpm->UnpinPage(i, false);
+  }
+  EXPECT_EQ(num_writes, disk_manager->GetNumWrites());
+  for (int i = num_scan_pages; i < num_scan_pages + num_hot_pages; ++i) {
+    auto *page = bpm->FetchPage(i);
+    EXPECT_EQ("hot " + std::to_string(i), std::string(page->GetData()));
+    bpm->UnpinPage(i, false);
+  }
+  EXPECT_EQ(num_writes, disk_manager->GetNumWrites());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ConcurrencyTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 16;
+  const int num_pages = 64;
+  const int num_threads = 8;
+  const int rounds = 2000;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Every page stores its own id, so a fetch that returns the wrong frame or stale data is detected.
+  for (int i = 0; i < num_pages; ++i) {
+    page_id_t page_id_temp;
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    ASSERT_EQ(i, page_id_temp);
+    snprintf(page->GetData(), PAGE_SIZE, "%d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: many threads hit and miss on a working set larger than the pool.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([bpm, tid] {
+      std::default_random_engine rng(tid);
+      std::uniform_int_distribution<int> page_dist(0, num_pages - 1);
+      for (int i = 0; i < rounds; ++i) {
+        page_id_t page_id = page_dist(rng);
+        auto *page = bpm->FetchPage(page_id);
+        if (page == nullptr) {
+          continue;
+        }
+        EXPECT_EQ(page_id, page->GetPageId());
+        EXPECT_EQ(page_id, std::stoi(page->GetData()));
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, i % 7 == 0));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // Scenario: all pages are unpinned again, so every frame can be reused.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id_temp;
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ConcurrentNewPageTest) {
+  const std::string db_name = "test.db";
+  const int num_threads = 8;
+  const int pages_per_thread = 200;
+  const size_t buffer_pool_size = num_threads * pages_per_thread;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: threads create pages at the same time. Every page gets its own id and its own frame.
+  std::vector<std::vector<page_id_t>> page_ids(num_threads);
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([bpm, &page_ids, tid] {
+      for (int i = 0; i < pages_per_thread; ++i) {
+        page_id_t page_id_temp;
+        auto *page = bpm->NewPage(&page_id_temp);
+        EXPECT_NE(nullptr, page);
+        if (page != nullptr) {
+          page_ids[tid].push_back(page_id_temp);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  std::vector<page_id_t> all_page_ids;
+  for (const auto &thread_page_ids : page_ids) {
+    all_page_ids.insert(all_page_ids.end(), thread_page_ids.begin(), thread_page_ids.end());
+  }
+  EXPECT_EQ(buffer_pool_size, all_page_ids.size());
+  std::sort(all_page_ids.begin(), all_page_ids.end());
+  EXPECT_EQ(all_page_ids.end(), std::adjacent_find(all_page_ids.begin(), all_page_ids.end()));
+
+  // Scenario: every page is still mapped to its own frame, pinned once.
+  for (page_id_t page_id : all_page_ids) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(page_id, page->GetPageId());
+    EXPECT_EQ(2, page->GetPinCount());
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// Throughput and hit ratio of concurrent fetch/unpin pairs, run with --gtest_also_run_disabled_tests.
+// The first run keeps the whole working set resident (pure hit path), the second uses a working set twice the size of
+// the pool so that hits have to coexist with misses doing disk I/O.
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, DISABLED_ConcurrentHitBenchmark) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 1024;
+  const int ops_per_thread = 200000;
+  const size_t max_threads = std::max(1U, std::thread::hardware_concurrency());
+
+  for (int working_set : {static_cast<int>(buffer_pool_size), static_cast<int>(buffer_pool_size * 2)}) {
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+    for (int i = 0; i < working_set; ++i) {
+      page_id_t page_id_temp;
+      ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+      bpm->UnpinPage(page_id_temp, false);
+    }
+
+    for (size_t num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+      bpm->ResetStats();
+      std::vector<std::thread> threads;
+      auto start = std::chrono::steady_clock::now();
+      for (size_t tid = 0; tid < num_threads; ++tid) {
+        threads.emplace_back([bpm, tid, working_set] {
+          std::default_random_engine rng(tid);
+          std::uniform_int_distribution<int> page_dist(0, working_set - 1);
+          for (int i = 0; i < ops_per_thread; ++i) {
+            page_id_t page_id = page_dist(rng);
+            if (bpm->FetchPage(page_id) != nullptr) {
+              bpm->UnpinPage(page_id, false);
+            }
+          }
+        });
+      }
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      std::cout << "working set " << working_set << " pages, " << num_threads << " threads: "
+                << static_cast<double>(num_threads * ops_per_thread) / elapsed.count() << " fetches/s, hit ratio "
+                << bpm->GetStats().HitRatio() << std::endl;
+    }
+
+    disk_manager->ShutDown();
+    remove("test.db");
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, BackgroundWriterTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: fill the buffer pool with dirty pages and unpin them.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %zu", i);
+    bpm->UnpinPage(page_id_temp, true);
+  }
+
+  // Scenario: the background writer cleans every frame.
+  bpm->RunBackgroundWriter(buffer_pool_size, buffer_pool_size, std::chrono::milliseconds(10));
+  for (int i = 0; i < 500 && bpm->GetStats().num_background_writebacks_ < buffer_pool_size; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  bpm->StopBackgroundWriter();
+  EXPECT_EQ(buffer_pool_size, bpm->GetStats().num_background_writebacks_);
+
+  // Scenario: new pages take clean victims, so no miss writes back a page itself.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    bpm->UnpinPage(page_id_temp, false);
+  }
+  EXPECT_EQ(0, bpm->GetStats().num_foreground_writebacks_);
+
+  // Scenario: the pages written back by the background writer can be read back.
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); ++page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData()));
+    bpm->UnpinPage(page_id, false);
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, PrefetchTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: write out twice as many pages as the buffer pool holds, so the first half is evicted.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < 2 * buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %zu", i);
+    bpm->UnpinPage(page_id_temp, true);
+  }
+
+  // Scenario: prefetched pages are read in without being pinned.
+  std::vector<page_id_t> page_ids;
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); ++page_id) {
+    page_ids.push_back(page_id);
+  }
+  bpm->PrefetchPages(page_ids);
+  for (page_id_t page_id : page_ids) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_EQ(1, page->GetPinCount());
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: prefetching is only a hint and does nothing when every frame is pinned.
+  for (page_id_t page_id : page_ids) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+  }
+  bpm->PrefetchPages({static_cast<page_id_t>(buffer_pool_size)});
+  EXPECT_EQ(nullptr, bpm->FetchPage(buffer_pool_size));
+  for (page_id_t page_id : page_ids) {
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, LazyNewPageTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: new pages are not written to disk when they are created.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    bpm->UnpinPage(page_id_temp, false);
+  }
+  EXPECT_EQ(0, disk_manager->GetNumWrites());
+  EXPECT_EQ(static_cast<page_id_t>(buffer_pool_size), disk_manager->GetNumPages());
+
+  // Scenario: a new page is written once when it is evicted and reads back as zeros.
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  bpm->UnpinPage(page_id_temp, false);
+  EXPECT_EQ(1, disk_manager->GetNumWrites());
+  auto *page = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(PAGE_SIZE, std::count(page->GetData(), page->GetData() + PAGE_SIZE, 0));
+  bpm->UnpinPage(0, false);
+
+  // Scenario: a new page that is deleted before it is evicted never reaches the disk. Only the dirty victim it
+  // replaced is written back.
+  int num_writes = disk_manager->GetNumWrites();
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  bpm->UnpinPage(page_id_temp, false);
+  EXPECT_TRUE(bpm->DeletePage(page_id_temp));
+  EXPECT_EQ(num_writes + 1, disk_manager->GetNumWrites());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ResizeTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 16;
+  const int num_pages = 64;
+  const int num_threads = 4;
+  const int rounds = 5000;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  for (int i = 0; i < num_pages; ++i) {
+    page_id_t page_id_temp;
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "%d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: the pool grows and shrinks while threads keep fetching pages, dirtying some of them.
+  std::atomic<bool> done = false;
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([bpm, tid] {
+      std::default_random_engine rng(tid);
+      std::uniform_int_distribution<int> page_dist(0, num_pages - 1);
+      for (int i = 0; i < rounds; ++i) {
+        page_id_t page_id = page_dist(rng);
+        auto *page = bpm->FetchPage(page_id);
+        if (page == nullptr) {
+          continue;
+        }
+        EXPECT_EQ(page_id, page->GetPageId());
+        EXPECT_EQ(page_id, std::stoi(page->GetData()));
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, i % 7 == 0));
+      }
+    });
+  }
+  std::thread resizer([bpm, &done] {
+    const size_t pool_sizes[] = {64, 8, 4 * buffer_pool_size, num_threads, 2 * num_pages, buffer_pool_size};
+    for (int i = 0; !done; i = (i + 1) % 6) {
+      bpm->Resize(pool_sizes[i]);
+    }
+  });
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  done = true;
+  resizer.join();
+
+  // Scenario: with nothing pinned, the pool reaches any size, and no page was lost on the way.
+  EXPECT_TRUE(bpm->Resize(2));
+  EXPECT_EQ(2, bpm->GetPoolSize());
+  EXPECT_TRUE(bpm->Resize(3 * buffer_pool_size));
+  EXPECT_EQ(3 * buffer_pool_size, bpm->GetPoolSize());
+  for (int i = 0; i < num_pages; ++i) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(i, std::stoi(page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+
+  // Scenario: pinned pages are never evicted by a shrink.
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(i));
+  }
+  EXPECT_FALSE(bpm->Resize(2));
+  EXPECT_EQ(4, bpm->GetPoolSize());
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(i, std::stoi(bpm->FetchPage(i)->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, WarmRestartTest) {
+  const std::string db_name = "test.db";
+  const std::string residency_file_name = "test.residency";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: fill the pool, then touch pages 2 and 5 again and keep page 7 pinned.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %zu", i);
+    bpm->UnpinPage(page_id_temp, true);
+  }
+  bpm->FlushAllPages();
+  for (page_id_t page_id : {2, 5, 7}) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+  }
+  bpm->UnpinPage(2, false);
+  bpm->UnpinPage(5, false);
+  EXPECT_EQ(7, bpm->GetResidentPages()[0]);
+  EXPECT_EQ(5, bpm->GetResidentPages()[1]);
+  EXPECT_EQ(2, bpm->GetResidentPages()[2]);
+  ASSERT_TRUE(bpm->SaveResidency(residency_file_name));
+  bpm->UnpinPage(7, false);
+  delete bpm;
+
+  // Scenario: a smaller pool restarts with the hottest pages it can hold.
+  bpm = new BufferPoolManagerInstance(4, disk_manager);
+  EXPECT_EQ(4, bpm->LoadResidency(residency_file_name));
+  bpm->StopPrefetchThread();
+  for (page_id_t page_id : {2, 5, 7, 9}) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData()));
+    bpm->UnpinPage(page_id, false);
+  }
+  EXPECT_EQ(4, bpm->GetStats().num_hits_);
+  EXPECT_EQ(0, bpm->GetStats().num_misses_);
+
+  // Scenario: a missing residency file is ignored.
+  EXPECT_EQ(0, bpm->LoadResidency("missing.residency"));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove(residency_file_name.c_str());
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, FetchPagesTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (int i = 0; i < 8; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", i);
+    bpm->UnpinPage(page_id_temp, true);
+  }
+  bpm->FlushAllPages();
+  bpm->ResetStats();
+
+  // Scenario: pages 6 and 7 are cached, pages 1 and 3 are read in one batch, and page 3 is listed twice. The last page
+  // does not fit because every frame is pinned.
+  std::vector<page_id_t> page_ids = {3, 7, 1, 3, 6, 0};
+  auto pages = bpm->FetchPages(page_ids);
+  ASSERT_EQ(page_ids.size(), pages.size());
+  for (size_t i = 0; i + 1 < pages.size(); ++i) {
+    ASSERT_NE(nullptr, pages[i]);
+    EXPECT_EQ("page " + std::to_string(page_ids[i]), std::string(pages[i]->GetData()));
+  }
+  EXPECT_EQ(nullptr, pages.back());
+  EXPECT_EQ(pages[0], pages[3]);
+  EXPECT_EQ(2, pages[0]->GetPinCount());
+  EXPECT_EQ(2, bpm->GetStats().num_misses_);
+  EXPECT_EQ(3, bpm->GetStats().num_hits_);
+
+  for (size_t i = 0; i + 1 < pages.size(); ++i) {
+    EXPECT_TRUE(bpm->UnpinPage(page_ids[i], false));
+  }
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ChecksumFailureTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 3;
+
+  auto *disk_manager = new DiskManager(db_name);
+  disk_manager->SetPageChecksums(true);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (int i = 0; i < 4; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", i);
+    bpm->UnpinPage(page_id_temp, true);
+  }
+  bpm->FlushAllPages();
+  delete bpm;
+
+  // Scenario: a byte of page 1 is corrupted on disk, and a fresh buffer pool refuses to serve the page.
+  {
+    std::fstream file(db_name, std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(PAGE_SIZE + 7);
+    file.put('X');
+  }
+  bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  EXPECT_EQ(nullptr, bpm->FetchPage(1));
+  EXPECT_EQ(1, disk_manager->GetNumChecksumFailures());
+
+  // Scenario: in a batch, only the corrupted page fails, including where it is listed twice.
+  std::vector<page_id_t> page_ids = {0, 1, 2, 1};
+  auto pages = bpm->FetchPages(page_ids);
+  ASSERT_EQ(page_ids.size(), pages.size());
+  ASSERT_NE(nullptr, pages[0]);
+  EXPECT_EQ("page 0", std::string(pages[0]->GetData()));
+  EXPECT_EQ(nullptr, pages[1]);
+  ASSERT_NE(nullptr, pages[2]);
+  EXPECT_EQ("page 2", std::string(pages[2]->GetData()));
+  EXPECT_EQ(nullptr, pages[3]);
+  EXPECT_TRUE(bpm->UnpinPage(0, false));
+  EXPECT_TRUE(bpm->UnpinPage(2, false));
+
+  // Scenario: a prefetch of the corrupted page does not leave it cached either.
+  bpm->PrefetchPages({1});
+  bpm->StopPrefetchThread();
+  EXPECT_EQ(nullptr, bpm->FetchPage(1));
+  EXPECT_EQ(4, disk_manager->GetNumChecksumFailures());
+
+  // Scenario: the frames of the failed reads went back to the pool, so every other page fits at once.
+  for (page_id_t page_id : {0, 2, 3}) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData()));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, DirectIOTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+
+  auto *disk_manager = new DiskManager(db_name, DiskWriteMode::WRITE_BACK, DiskIOMode::DIRECT);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: the frames are aligned, so they can be handed to the kernel as they are.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(bpm->GetPages()[i].GetData()) % PAGE_SIZE);
+  }
+
+  // Scenario: pages survive being evicted and read back with direct I/O.
+  page_id_t page_id_temp;
+  for (int i = 0; i < 12; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", i);
+    bpm->UnpinPage(page_id_temp, true);
+  }
+  for (int i = 0; i < 12; ++i) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(i), std::string(page->GetData()));
+    bpm->UnpinPage(i, false);
+  }
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, CompressedCacheTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+  const int num_pages = 20;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  bpm->EnableCompressedCache(4 * PAGE_SIZE);
+
+  // Scenario: five times more mostly empty pages than frames. Evicted dirty pages stay in the compressed page cache.
+  page_id_t page_id_temp;
+  for (int i = 0; i < num_pages; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", i);
+    bpm->UnpinPage(page_id_temp, true);
+  }
+  EXPECT_EQ(0, disk_manager->GetNumWrites());
+  EXPECT_EQ(num_pages - buffer_pool_size, bpm->GetStats().num_compressed_pages_);
+
+  // Scenario: every page reads back without touching the disk. The first fetches evict the last pages created, so
+  // every fetch is served by the compressed page cache.
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData()));
+    bpm->UnpinPage(page_id, false);
+  }
+  auto stats = bpm->GetStats();
+  EXPECT_EQ(num_pages, stats.num_compressed_hits_);
+  EXPECT_EQ(0, stats.num_compressed_misses_);
+
+  // Scenario: flushing a single page that only lives in the compressed page cache writes back its dirty copy once.
+  EXPECT_TRUE(bpm->FlushPage(0));
+  EXPECT_EQ(1, disk_manager->GetNumWrites());
+  char data[PAGE_SIZE];
+  disk_manager->ReadPage(0, data);
+  EXPECT_EQ("page 0", std::string(data));
+  EXPECT_TRUE(bpm->FlushPage(0));
+  EXPECT_EQ(1, disk_manager->GetNumWrites());
+  EXPECT_FALSE(bpm->FlushPage(num_pages));
+
+  // Scenario: flushing writes back the dirty pages of both tiers, and a fresh buffer pool reads them from disk.
+  bpm->FlushAllPages();
+  EXPECT_EQ(num_pages, disk_manager->GetNumWrites());
+  delete bpm;
+  bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData()));
+    bpm->UnpinPage(page_id, false);
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, StatsTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: new pages fill the pool; two stay pinned, one of them twice, and one is unpinned dirty.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+  bpm->FlushAllPages();
+  EXPECT_NE(nullptr, bpm->FetchPage(0));
+  bpm->UnpinPage(2, true);
+  bpm->UnpinPage(3, false);
+
+  auto stats = bpm->GetStats();
+  EXPECT_EQ(buffer_pool_size, stats.num_new_pages_);
+  EXPECT_EQ(buffer_pool_size, stats.num_flushes_);
+  EXPECT_EQ(1, stats.num_hits_);
+  EXPECT_EQ(0, stats.num_misses_);
+  EXPECT_EQ(buffer_pool_size, stats.pool_size_);
+  EXPECT_EQ(0, stats.num_free_frames_);
+  EXPECT_EQ(1, stats.num_dirty_frames_);
+  EXPECT_EQ(2, stats.pin_count_histogram_[0]);
+  EXPECT_EQ(1, stats.pin_count_histogram_[1]);
+  EXPECT_EQ(1, stats.pin_count_histogram_[2]);
+
+  // Scenario: three more pages evict the unpinned ones. Page 2 and the first of the new pages, which is dirty since it
+  // was never written, are written back by the thread that needed their frame.
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  bpm->UnpinPage(page_id_temp, false);
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  bpm->UnpinPage(page_id_temp, false);
+  ASSERT_NE(nullptr, bpm->FetchPage(2));
+  stats = bpm->GetStats();
+  EXPECT_EQ(3, stats.num_evictions_);
+  EXPECT_EQ(1, stats.num_misses_);
+  EXPECT_EQ(2, stats.num_foreground_writebacks_);
+  EXPECT_DOUBLE_EQ(0.5, stats.HitRatio());
+
+  // Scenario: resetting clears the counters but not the gauges.
+  bpm->ResetStats();
+  stats = bpm->GetStats();
+  EXPECT_EQ(0, stats.num_hits_);
+  EXPECT_EQ(0, stats.num_evictions_);
+  EXPECT_EQ(0, stats.HitRatio());
+  EXPECT_EQ(buffer_pool_size, stats.pool_size_);
+  EXPECT_EQ(3, stats.pin_count_histogram_[1] + stats.pin_count_histogram_[2]);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, IOStatsTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 1;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: a flushed page is written back for a checkpoint.
+  page_id_t page_id_temp;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  bpm->UnpinPage(page_id_temp, true);
+  bpm->FlushPage(page_id_temp);
+  auto stats = disk_manager->GetIOStats();
+  EXPECT_EQ(1, stats.Get(IOOperation::WRITE_PAGE, IOCategory::CHECKPOINT).count_);
+  EXPECT_EQ(0, stats.Get(IOOperation::WRITE_PAGE, IOCategory::EVICTION).count_);
+
+  // Scenario: a dirty page is written back for an eviction, and a miss reads it back in.
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  bpm->UnpinPage(0, true);
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  bpm->UnpinPage(page_id_temp, false);
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  bpm->UnpinPage(0, false);
+  stats = disk_manager->GetIOStats();
+  EXPECT_EQ(1, stats.Get(IOOperation::WRITE_PAGE, IOCategory::CHECKPOINT).count_);
+  EXPECT_EQ(2, stats.Get(IOOperation::WRITE_PAGE, IOCategory::EVICTION).count_);
+  EXPECT_EQ(1, stats.Get(IOOperation::READ_PAGE, IOCategory::BUFFER_MISS).count_);
+  EXPECT_EQ(0, stats.Get(IOOperation::READ_PAGE, IOCategory::OTHER).count_);
+  EXPECT_EQ(0, stats.Get(IOOperation::WRITE_PAGE, IOCategory::OTHER).count_);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// Time to flush a pool full of dirty pages, syncing every page versus syncing once at the end.
+// Run with --gtest_also_run_disabled_tests.
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, DISABLED_FlushAllBenchmark) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 2048;
+
+  for (DiskWriteMode write_mode : {DiskWriteMode::WRITE_THROUGH, DiskWriteMode::WRITE_BACK}) {
+    auto *disk_manager = new DiskManager(db_name, write_mode);
+    auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+    page_id_t page_id_temp;
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+      bpm->UnpinPage(page_id_temp, true);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    bpm->FlushAllPages();
+    if (write_mode == DiskWriteMode::WRITE_BACK) {
+      disk_manager->Sync();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << (write_mode == DiskWriteMode::WRITE_THROUGH ? "write-through" : "write-back + sync") << ": "
+              << buffer_pool_size << " pages in " << elapsed.count() * 1000 << " ms, " << disk_manager->GetNumSyncs()
+              << " syncs" << std::endl;
+
+    disk_manager->ShutDown();
+    remove("test.db");
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
 }  // namespace bustub
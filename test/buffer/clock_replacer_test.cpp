@@ -10,16 +10,23 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
 #include <thread>  // NOLINT
 #include <vector>
 
 #include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
 #include "gtest/gtest.h"
 
 namespace bustub {
 
-TEST(ClockReplacerTest, DISABLED_SampleTest) {
+TEST(ClockReplacerTest, SampleTest) {
   ClockReplacer clock_replacer(7);
 
   // Scenario: unpin six elements, i.e. add them to the replacer.
@@ -57,6 +64,130 @@ TEST(ClockReplacerTest, DISABLED_SampleTest) {
   EXPECT_EQ(6, value);
   clock_replacer.Victim(&value);
   EXPECT_EQ(4, value);
+  EXPECT_EQ(0, clock_replacer.Size());
+  EXPECT_FALSE(clock_replacer.Victim(&value));
+}
+
+TEST(ClockReplacerTest, GrowTest) {
+  ClockReplacer clock_replacer(2);
+
+  // Scenario: frame ids beyond the initial capacity become usable once the capacity grows.
+  clock_replacer.SetCapacity(7);
+  clock_replacer.Unpin(6);
+  clock_replacer.Unpin(1);
+  clock_replacer.Pin(1);
+  EXPECT_EQ(1, clock_replacer.Size());
+  ASSERT_EQ(1, clock_replacer.GetEvictionOrder().size());
+  EXPECT_EQ(6, clock_replacer.GetEvictionOrder()[0]);
+
+  int value;
+  ASSERT_TRUE(clock_replacer.Victim(&value));
+  EXPECT_EQ(6, value);
+  EXPECT_FALSE(clock_replacer.Victim(&value));
+}
+
+// NOLINTNEXTLINE
+TEST(ClockReplacerTest, ConcurrencyTest) {
+  const int num_threads = 4;
+  const int frames_per_thread = 256;
+  ClockReplacer clock_replacer(num_threads * frames_per_thread);
+
+  // Scenario: every thread unpins and pins its own frames, leaving every other frame evictable.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&clock_replacer, tid] {
+      for (int round = 0; round < 100; ++round) {
+        for (int i = 0; i < frames_per_thread; ++i) {
+          frame_id_t frame_id = tid * frames_per_thread + i;
+          clock_replacer.Unpin(frame_id);
+          if (i % 2 == 0) {
+            clock_replacer.Pin(frame_id);
+          }
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(num_threads * frames_per_thread / 2, clock_replacer.Size());
+
+  // Scenario: concurrent victims never hand out the same frame twice.
+  std::vector<std::vector<frame_id_t>> victims(num_threads);
+  threads.clear();
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&clock_replacer, &victims, tid] {
+      frame_id_t frame_id;
+      while (clock_replacer.Victim(&frame_id)) {
+        victims[tid].push_back(frame_id);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  std::vector<bool> seen(num_threads * frames_per_thread, false);
+  size_t num_victims = 0;
+  for (const auto &thread_victims : victims) {
+    for (frame_id_t frame_id : thread_victims) {
+      EXPECT_EQ(1, frame_id % 2);
+      EXPECT_FALSE(seen[frame_id]);
+      seen[frame_id] = true;
+      num_victims++;
+    }
+  }
+  EXPECT_EQ(num_threads * frames_per_thread / 2, num_victims);
+  EXPECT_EQ(0, clock_replacer.Size());
+}
+
+// Throughput of concurrent pin/unpin pairs on random frames, with an occasional victim, for each replacer.
+// Run with --gtest_also_run_disabled_tests.
+// NOLINTNEXTLINE
+TEST(ClockReplacerTest, DISABLED_ContentionBenchmark) {
+  const size_t num_frames = 1024;
+  const int ops_per_thread = 500000;
+  const size_t max_threads = std::max(1U, std::thread::hardware_concurrency());
+
+  for (const auto &name : std::vector<std::string>{"LRU", "LRU-K", "CLOCK"}) {
+    for (size_t num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+      std::unique_ptr<Replacer> replacer;
+      if (name == "LRU") {
+        replacer = std::make_unique<LRUReplacer>(num_frames);
+      } else if (name == "LRU-K") {
+        replacer = std::make_unique<LRUKReplacer>(num_frames);
+      } else {
+        replacer = std::make_unique<ClockReplacer>(num_frames);
+      }
+      for (size_t i = 0; i < num_frames; ++i) {
+        replacer->Unpin(static_cast<frame_id_t>(i));
+      }
+
+      std::vector<std::thread> threads;
+      auto start = std::chrono::steady_clock::now();
+      for (size_t tid = 0; tid < num_threads; ++tid) {
+        threads.emplace_back([&replacer, tid] {
+          std::default_random_engine rng(tid);
+          std::uniform_int_distribution<frame_id_t> frame_dist(0, num_frames - 1);
+          for (int i = 0; i < ops_per_thread; ++i) {
+            frame_id_t frame_id = frame_dist(rng);
+            replacer->Pin(frame_id);
+            replacer->RecordAccess(frame_id);
+            replacer->Unpin(frame_id);
+            if (i % 64 == 0 && replacer->Victim(&frame_id)) {
+              replacer->Unpin(frame_id);
+            }
+          }
+        });
+      }
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      std::cout << name << ", " << num_threads << " threads: "
+                << static_cast<double>(num_threads * ops_per_thread) / elapsed.count() << " pin/unpin pairs/s"
+                << std::endl;
+    }
+  }
 }
 
 }  // namespace bustub
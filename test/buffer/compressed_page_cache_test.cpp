@@ -0,0 +1,114 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_cache_test.cpp
+//
+// Identification: test/buffer/compressed_page_cache_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/compressed_page_cache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(CompressedPageCacheTest, CodecTest) {
+  char page[PAGE_SIZE];
+  char restored[PAGE_SIZE];
+  std::string compressed;
+
+  // Scenario: an empty page shrinks to a small fraction of its size.
+  memset(page, 0, PAGE_SIZE);
+  CompressedPageCache::Compress(page, PAGE_SIZE, &compressed);
+  EXPECT_LT(compressed.size(), PAGE_SIZE / 16);
+  ASSERT_TRUE(CompressedPageCache::Decompress(compressed, restored, PAGE_SIZE));
+  EXPECT_EQ(0, memcmp(page, restored, PAGE_SIZE));
+
+  // Scenario: repetitive tuples compress, and short repeats at the end are kept as literals.
+  for (int i = 0; i < PAGE_SIZE / 32; ++i) {
+    snprintf(page + i * 32, 32, "tuple %d: name=bustub_%d", i, i % 7);
+  }
+  CompressedPageCache::Compress(page, PAGE_SIZE, &compressed);
+  EXPECT_LT(compressed.size(), PAGE_SIZE / 2);
+  ASSERT_TRUE(CompressedPageCache::Decompress(compressed, restored, PAGE_SIZE));
+  EXPECT_EQ(0, memcmp(page, restored, PAGE_SIZE));
+
+  // Scenario: random bytes do not compress, but still round trip.
+  std::mt19937 rng(15445);
+  for (char &c : page) {
+    c = static_cast<char>(rng());
+  }
+  CompressedPageCache::Compress(page, PAGE_SIZE, &compressed);
+  EXPECT_GE(compressed.size(), PAGE_SIZE);
+  ASSERT_TRUE(CompressedPageCache::Decompress(compressed, restored, PAGE_SIZE));
+  EXPECT_EQ(0, memcmp(page, restored, PAGE_SIZE));
+
+  // Scenario: truncated input and back references before the start of the output are rejected.
+  EXPECT_FALSE(CompressedPageCache::Decompress(compressed.substr(0, compressed.size() / 2), restored, PAGE_SIZE));
+  EXPECT_FALSE(CompressedPageCache::Decompress(std::string("\x80\x01\x00", 3), restored, PAGE_SIZE));
+}
+
+// NOLINTNEXTLINE
+TEST(CompressedPageCacheTest, EvictionTest) {
+  const std::string db_name = "test.db";
+  auto *disk_manager = new DiskManager(db_name);
+  char page[PAGE_SIZE];
+  char restored[PAGE_SIZE];
+  bool is_dirty;
+
+  // Scenario: two pages of random bytes fill the budget.
+  std::mt19937 rng(15445);
+  CompressedPageCache cache(2 * PAGE_SIZE, disk_manager);
+  for (page_id_t page_id = 0; page_id < 3; ++page_id) {
+    for (char &c : page) {
+      c = static_cast<char>(rng());
+    }
+    cache.Insert(page_id, page, page_id == 0);
+  }
+  EXPECT_EQ(2, cache.GetNumPages());
+  EXPECT_EQ(2 * PAGE_SIZE, cache.GetSize());
+
+  // Scenario: the oldest page was dirty, so evicting it wrote it back.
+  EXPECT_EQ(1, disk_manager->GetNumWrites());
+  EXPECT_FALSE(cache.Take(0, restored, &is_dirty));
+
+  // Scenario: a hit moves the page out of the cache.
+  ASSERT_TRUE(cache.Take(2, restored, &is_dirty));
+  EXPECT_FALSE(is_dirty);
+  EXPECT_EQ(0, memcmp(page, restored, PAGE_SIZE));
+  EXPECT_FALSE(cache.Take(2, restored, &is_dirty));
+  EXPECT_EQ(1, cache.GetNumHits());
+  EXPECT_EQ(2, cache.GetNumMisses());
+
+  // Scenario: compressible dirty pages take little room and are written back on flush, but stay cached.
+  memset(page, 0, PAGE_SIZE);
+  for (page_id_t page_id = 3; page_id < 10; ++page_id) {
+    cache.Insert(page_id, page, true);
+  }
+  EXPECT_EQ(8, cache.GetNumPages());
+  cache.FlushAll();
+  EXPECT_EQ(8, disk_manager->GetNumWrites());
+  ASSERT_TRUE(cache.Take(5, restored, &is_dirty));
+  EXPECT_FALSE(is_dirty);
+
+  // Scenario: erased pages are dropped without being written back.
+  cache.Insert(4, page, true);
+  cache.Erase(4);
+  EXPECT_FALSE(cache.Take(4, restored, &is_dirty));
+  EXPECT_EQ(8, disk_manager->GetNumWrites());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+}  // namespace bustub
@@ -0,0 +1,184 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer_test.cpp
+//
+// Identification: test/buffer/lru_k_replacer_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <string>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/lru_k_replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(LRUKReplacerTest, SampleTest) {
+  LRUKReplacer lru_k_replacer(7, 2);
+
+  // Scenario: frames 1-6 are referenced once, frame 1 is referenced a second time.
+  for (int i = 1; i <= 6; ++i) {
+    lru_k_replacer.RecordAccess(i);
+  }
+  lru_k_replacer.RecordAccess(1);
+  for (int i = 1; i <= 6; ++i) {
+    lru_k_replacer.Unpin(i);
+  }
+  EXPECT_EQ(6, lru_k_replacer.Size());
+
+  // Scenario: frames with fewer than two references go first, in LRU order. Frame 1 has a finite K-distance.
+  int value;
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(3, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(4, value);
+  EXPECT_EQ(3, lru_k_replacer.Size());
+
+  // Scenario: pinned frames are not evictable. Note that 3 has already been victimized.
+  lru_k_replacer.Pin(3);
+  lru_k_replacer.Pin(5);
+  EXPECT_EQ(2, lru_k_replacer.Size());
+
+  // Scenario: frame 5 gets a second reference. Frame 6 is now the only frame with an infinite K-distance.
+  lru_k_replacer.RecordAccess(5);
+  lru_k_replacer.Unpin(5);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(6, value);
+
+  // Scenario: frame 1's second most recent reference is older than frame 5's.
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(5, value);
+  EXPECT_EQ(0, lru_k_replacer.Size());
+  EXPECT_FALSE(lru_k_replacer.Victim(&value));
+}
+
+TEST(LRUKReplacerTest, CorrelatedReferenceTest) {
+  LRUKReplacer lru_k_replacer(4, 2, 2);
+
+  // Scenario: back-to-back references to frame 1 are correlated and count as a single reference,
+  // so frame 1 still has an infinite K-distance and its only reference is older than frame 2's.
+  lru_k_replacer.RecordAccess(1);
+  lru_k_replacer.RecordAccess(1);
+  lru_k_replacer.RecordAccess(2);
+  lru_k_replacer.Unpin(1);
+  lru_k_replacer.Unpin(2);
+
+  int value;
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+
+  // Scenario: frame 4 comes first in LRU order, but it is still inside its correlated reference period.
+  lru_k_replacer.RecordAccess(4);
+  lru_k_replacer.RecordAccess(3);
+  lru_k_replacer.RecordAccess(4);
+  lru_k_replacer.RecordAccess(1);
+  lru_k_replacer.Unpin(3);
+  lru_k_replacer.Unpin(4);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(3, value);
+
+  // Scenario: nothing else is evictable, so frame 4 is evicted anyway.
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(4, value);
+}
+
+TEST(LRUKReplacerTest, RemoveTest) {
+  LRUKReplacer lru_k_replacer(4, 2, 0);
+
+  // Scenario: frame 1 is referenced twice, then removed because its page was deleted.
+  lru_k_replacer.RecordAccess(1);
+  lru_k_replacer.RecordAccess(1);
+  lru_k_replacer.Unpin(1);
+  lru_k_replacer.Remove(1);
+  EXPECT_EQ(0, lru_k_replacer.Size());
+
+  // Scenario: the next page in frame 1 starts without the deleted page's references, so both frames have an infinite
+  // K-distance and frame 1, referenced first, goes first.
+  lru_k_replacer.RecordAccess(1);
+  lru_k_replacer.RecordAccess(2);
+  lru_k_replacer.Unpin(1);
+  lru_k_replacer.Unpin(2);
+  int value;
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+}
+
+TEST(LRUKReplacerTest, FailedEvictionTest) {
+  LRUKReplacer lru_k_replacer(4, 2, 0);
+
+  // Scenario: frame 2 is the victim, but the buffer pool fails to evict it because its page was pinned again.
+  lru_k_replacer.RecordAccess(1);
+  lru_k_replacer.RecordAccess(2);
+  lru_k_replacer.RecordAccess(1);
+  lru_k_replacer.Unpin(1);
+  lru_k_replacer.Unpin(2);
+  int value;
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+  EXPECT_EQ(1, lru_k_replacer.Size());
+
+  // Scenario: frame 2 kept its history, so with its new reference it has a finite K-distance, and its second most
+  // recent reference is younger than frame 1's.
+  lru_k_replacer.RecordAccess(2);
+  lru_k_replacer.Unpin(2);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+}
+
+// NOLINTNEXTLINE
+TEST(LRUKReplacerTest, ScanResistanceTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const int num_hot_pages = 5;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, nullptr, ReplacerType::LRU_K);
+
+  // Scenario: the hot pages are referenced repeatedly.
+  page_id_t page_id_temp;
+  for (int i = 0; i < num_hot_pages; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    snprintf(bpm->FetchPage(page_id_temp)->GetData(), PAGE_SIZE, "hot %d", i);
+    bpm->UnpinPage(page_id_temp, true);
+    bpm->UnpinPage(page_id_temp, true);
+  }
+
+  // Scenario: a scan over many more pages than the pool holds only recycles its own frames.
+  for (int i = 0; i < 50; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    bpm->UnpinPage(page_id_temp, false);
+  }
+  int num_writes = disk_manager->GetNumWrites();
+  for (int i = 0; i < num_hot_pages; ++i) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("hot " + std::to_string(i), std::string(page->GetData()));
+    bpm->UnpinPage(i, false);
+  }
+  // The hot pages were never written back, so they were never evicted.
+  EXPECT_EQ(num_writes, disk_manager->GetNumWrites());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
@@ -11,9 +11,11 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/parallel_buffer_pool_manager.h"
+#include <algorithm>
 #include <cstdio>
 #include <random>
 #include <string>
+#include <vector>
 #include "buffer/buffer_pool_manager.h"
 #include "gtest/gtest.h"
 
@@ -151,4 +153,254 @@ TEST(ParallelBufferPoolManagerTest, SampleTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, FrameBorrowingTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 5;
+  const size_t num_instances = 2;
+  const int num_pages = 20;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (int i = 0; i < num_pages; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: pin every frame of the instance that holds the even pages.
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(2 * buffer_pool_size); page_id += 2) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+  }
+
+  // Scenario: more even pages can still be fetched, with frames borrowed from the other instance.
+  for (page_id_t page_id = 2 * buffer_pool_size; page_id < num_pages; page_id += 2) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData()));
+  }
+  EXPECT_EQ(num_instances * buffer_pool_size, bpm->GetPoolSize());
+
+  // Scenario: now every frame is pinned.
+  EXPECT_EQ(nullptr, bpm->FetchPage(1));
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+
+  // Scenario: once unpinned, the borrowing instance's frames serve odd pages again.
+  for (page_id_t page_id = 0; page_id < num_pages; page_id += 2) {
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  for (page_id_t page_id = 1; page_id < num_pages; page_id += 2) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData()));
+  }
+  for (page_id_t page_id = 1; page_id < num_pages; page_id += 2) {
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, FetchPagesTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 5;
+  const size_t num_instances = 3;
+  const int num_pages = 30;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (int i = 0; i < num_pages; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: a batch spread over every instance comes back pinned and in order.
+  std::vector<page_id_t> page_ids = {29, 0, 7, 14, 3, 0, 22};
+  auto pages = bpm->FetchPages(page_ids);
+  ASSERT_EQ(page_ids.size(), pages.size());
+  for (size_t i = 0; i < pages.size(); ++i) {
+    ASSERT_NE(nullptr, pages[i]);
+    EXPECT_EQ(page_ids[i], pages[i]->GetPageId());
+    EXPECT_EQ("page " + std::to_string(page_ids[i]), std::string(pages[i]->GetData()));
+  }
+  EXPECT_EQ(2, pages[1]->GetPinCount());
+
+  // Scenario: a batch for one instance that needs more frames than it has borrows them from the others.
+  std::vector<page_id_t> instance_page_ids;
+  for (page_id_t page_id = 1; page_id < 27; page_id += 3) {
+    instance_page_ids.push_back(page_id);
+  }
+  auto more_pages = bpm->FetchPages(instance_page_ids);
+  for (size_t i = 0; i < more_pages.size(); ++i) {
+    ASSERT_NE(nullptr, more_pages[i]);
+    EXPECT_EQ("page " + std::to_string(instance_page_ids[i]), std::string(more_pages[i]->GetData()));
+  }
+
+  for (page_id_t page_id : page_ids) {
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  for (page_id_t page_id : instance_page_ids) {
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, FlushAllTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 30;
+  const size_t num_instances = 3;
+  const int num_pages = 24;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (int i = 0; i < num_pages; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: the dirty pages of all instances form one run, written as one vectored write per instance's slice.
+  bpm->FlushAllPages();
+  EXPECT_EQ(num_pages, disk_manager->GetNumWrites());
+  EXPECT_EQ(num_instances, disk_manager->GetNumWriteCalls());
+
+  // Scenario: clean pages are not written again; a dirty page in the middle is written on its own.
+  EXPECT_NE(nullptr, bpm->FetchPage(10));
+  EXPECT_TRUE(bpm->UnpinPage(10, true));
+  bpm->FlushAllPages();
+  EXPECT_EQ(num_pages + 1, disk_manager->GetNumWrites());
+  EXPECT_EQ(num_instances + 1, disk_manager->GetNumWriteCalls());
+
+  delete bpm;
+  bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, StatsTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t num_instances = 3;
+  const int num_pages = 12;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+  page_id_t page_id_temp;
+  for (int i = 0; i < num_pages; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+  bpm->FlushAllPages();
+  auto stats = bpm->GetStats();
+  EXPECT_EQ(num_pages, stats.num_new_pages_);
+  EXPECT_EQ(num_pages, stats.num_flushes_);
+
+  // Scenario: a fresh pool misses every page once, then hits it. The pages, and so the misses and hits, are spread
+  // evenly over the instances.
+  delete bpm;
+  bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+  for (int round = 0; round < 2; ++round) {
+    for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+      ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+      EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    }
+  }
+
+  // Scenario: the pool's statistics are the sums over its instances.
+  stats = bpm->GetStats();
+  EXPECT_EQ(num_pages, stats.num_misses_);
+  EXPECT_EQ(num_pages, stats.num_hits_);
+  EXPECT_DOUBLE_EQ(0.5, stats.HitRatio());
+  EXPECT_EQ(0, stats.num_new_pages_);
+  EXPECT_EQ(0, stats.num_evictions_);
+  EXPECT_EQ(num_instances * buffer_pool_size, stats.pool_size_);
+  EXPECT_EQ(num_instances * buffer_pool_size - num_pages, stats.num_free_frames_);
+  EXPECT_EQ(num_pages, stats.pin_count_histogram_[0]);
+
+  // Scenario: resetting clears the counters of every instance.
+  bpm->ResetStats();
+  stats = bpm->GetStats();
+  EXPECT_EQ(0, stats.num_hits_ + stats.num_misses_);
+  EXPECT_EQ(num_instances * buffer_pool_size, stats.pool_size_);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, PageReuseTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 12;
+  const size_t num_instances = 3;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (int i = 0; i < 12; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+  bpm->FlushAllPages();
+
+  // Scenario: deleted pages are reused by the instance they belong to instead of growing the file.
+  for (page_id_t page_id : {2, 4, 5, 9}) {
+    EXPECT_TRUE(bpm->DeletePage(page_id));
+  }
+  EXPECT_EQ(4, disk_manager->GetNumFreePages());
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < num_instances; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    page_ids.push_back(page_id_temp);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+  std::sort(page_ids.begin(), page_ids.end());
+  EXPECT_EQ(std::vector<page_id_t>({2, 4, 9}), page_ids);
+  EXPECT_EQ(12, disk_manager->GetNumPages());
+  // Page 5 was claimed along with page 2 in one extent.
+  EXPECT_EQ(0, disk_manager->GetNumFreePages());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fsm");
+
+  delete bpm;
+  delete disk_manager;
+}
+
 }  // namespace bustub
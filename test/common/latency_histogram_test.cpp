@@ -0,0 +1,104 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// latency_histogram_test.cpp
+//
+// Identification: test/common/latency_histogram_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdint>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/latency_histogram.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(LatencyHistogramTest, BucketTest) {
+  // Scenario: buckets are contiguous, and every value falls in the bucket whose bounds enclose it.
+  EXPECT_EQ(0, LatencyHistogram::BucketLowerBound(0));
+  for (size_t i = 0; i + 1 < LatencyHistogram::NUM_BUCKETS; i++) {
+    EXPECT_EQ(LatencyHistogram::BucketUpperBound(i) + 1, LatencyHistogram::BucketLowerBound(i + 1));
+    EXPECT_EQ(i, LatencyHistogram::BucketIndex(LatencyHistogram::BucketLowerBound(i)));
+    EXPECT_EQ(i, LatencyHistogram::BucketIndex(LatencyHistogram::BucketUpperBound(i)));
+  }
+
+  // Scenario: small values are exact, larger ones are known to within 12.5%.
+  for (uint64_t ns = 0; ns < LatencyHistogram::NUM_SUB_BUCKETS; ns++) {
+    EXPECT_EQ(ns, LatencyHistogram::BucketIndex(ns));
+  }
+  for (uint64_t ns : {9UL, 100UL, 1000UL, 12345UL, 1000000UL, 987654321UL}) {
+    auto index = LatencyHistogram::BucketIndex(ns);
+    EXPECT_LE(LatencyHistogram::BucketLowerBound(index), ns);
+    EXPECT_GE(LatencyHistogram::BucketUpperBound(index), ns);
+    EXPECT_LE(LatencyHistogram::BucketUpperBound(index) - LatencyHistogram::BucketLowerBound(index), ns / 8);
+  }
+
+  // Scenario: huge values land in the last bucket.
+  EXPECT_EQ(LatencyHistogram::NUM_BUCKETS - 1, LatencyHistogram::BucketIndex(UINT64_MAX));
+  EXPECT_EQ(UINT64_MAX, LatencyHistogram::BucketUpperBound(LatencyHistogram::NUM_BUCKETS - 1));
+}
+
+// NOLINTNEXTLINE
+TEST(LatencyHistogramTest, PercentileTest) {
+  LatencyRecorder recorder;
+  EXPECT_EQ(0, recorder.Snapshot().Percentile(50));
+
+  // Scenario: 1..1000 us; percentiles are upper bounds within 12.5%, and never above the max.
+  for (uint64_t us = 1; us <= 1000; us++) {
+    recorder.Record(us * 1000);
+  }
+  auto histogram = recorder.Snapshot();
+  EXPECT_EQ(1000, histogram.count_);
+  EXPECT_EQ(1000000, histogram.max_ns_);
+  EXPECT_DOUBLE_EQ(500500, histogram.Mean());
+  for (double percentile : {1.0, 50.0, 90.0, 99.0}) {
+    auto expected = static_cast<uint64_t>(percentile * 10) * 1000;
+    EXPECT_GE(histogram.Percentile(percentile), expected);
+    EXPECT_LE(histogram.Percentile(percentile), expected + expected / 8);
+  }
+  EXPECT_EQ(1000000, histogram.Percentile(100));
+
+  // Scenario: merging histograms adds their counts.
+  auto merged = histogram;
+  merged += histogram;
+  EXPECT_EQ(2000, merged.count_);
+  EXPECT_EQ(histogram.Percentile(50), merged.Percentile(50));
+  EXPECT_EQ(1000000, merged.max_ns_);
+
+  recorder.Reset();
+  histogram = recorder.Snapshot();
+  EXPECT_EQ(0, histogram.count_);
+  EXPECT_EQ(0, histogram.max_ns_);
+}
+
+// NOLINTNEXTLINE
+TEST(LatencyHistogramTest, ConcurrentRecordTest) {
+  const int num_threads = 4;
+  const uint64_t num_values = 10000;
+  LatencyRecorder recorder;
+
+  // Scenario: values recorded from many threads are all counted once the threads are done.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&recorder, tid] {
+      for (uint64_t i = 0; i < num_values; i++) {
+        recorder.Record(i + tid);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto histogram = recorder.Snapshot();
+  EXPECT_EQ(num_threads * num_values, histogram.count_);
+  EXPECT_EQ(num_values - 1 + num_threads - 1, histogram.max_ns_);
+}
+
+}  // namespace bustub
@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <atomic>
 #include <thread>  // NOLINT
 #include <vector>
 
@@ -117,4 +118,86 @@ TEST(HashTableTest, SampleTest) {
   delete bpm;
 }
 
+// NOLINTNEXTLINE
+TEST(HashTableTest, MergeDeletesBucketsTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+  const int num_keys = 5000;
+
+  // Scenario: with no lookup in flight, the buckets dropped by merges are deleted right away.
+  for (int i = 0; i < num_keys; i++) {
+    ht.Insert(nullptr, i, i);
+  }
+  EXPECT_LT(0, ht.GetGlobalDepth());
+  for (int i = 0; i < num_keys; i++) {
+    ht.Remove(nullptr, i, i);
+  }
+  ht.VerifyIntegrity();
+  EXPECT_LT(0, disk_manager->GetNumFreePages());
+
+  // Scenario: the deleted pages are handed out again by the splits of the next round.
+  for (int i = 0; i < num_keys; i++) {
+    ht.Insert(nullptr, i, i);
+  }
+  ht.VerifyIntegrity();
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    ASSERT_EQ(1, res.size());
+    EXPECT_EQ(i, res[0]);
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, ConcurrentSplitMergeTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(100, disk_manager);
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+  const int num_stable_keys = 1000;
+  const int num_keys = 20000;
+
+  for (int i = 0; i < num_stable_keys; i++) {
+    ht.Insert(nullptr, i, i);
+  }
+
+  // Scenario: lookups of keys that are always present never miss while other keys split and merge the buckets.
+  std::atomic<bool> done = false;
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 4; t++) {
+    readers.emplace_back([&ht, &done] {
+      while (!done) {
+        for (int i = 0; i < num_stable_keys; i++) {
+          std::vector<int> res;
+          ht.GetValue(nullptr, i, &res);
+          ASSERT_EQ(1, res.size()) << "Failed to find " << i << std::endl;
+          ASSERT_EQ(i, res[0]);
+        }
+      }
+    });
+  }
+  for (int i = num_stable_keys; i < num_keys; i++) {
+    ht.Insert(nullptr, i, i);
+  }
+  for (int i = num_stable_keys; i < num_keys; i++) {
+    ht.Remove(nullptr, i, i);
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+
+  ht.VerifyIntegrity();
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
 }  // namespace bustub
@@ -0,0 +1,188 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_disk_manager_test.cpp
+//
+// Identification: test/storage/async_disk_manager_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <future>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/disk/async_disk_manager.h"
+
+namespace bustub {
+
+class AsyncDiskManagerTest : public ::testing::Test {
+ protected:
+  // This function is called before every test.
+  void SetUp() override {
+    remove("test.db");
+    remove("test.log");
+  }
+
+  // This function is called after every test.
+  void TearDown() override {
+    remove("test.db");
+    remove("test.log");
+  };
+};
+
+// NOLINTNEXTLINE
+TEST_F(AsyncDiskManagerTest, ReadWritePageTest) {
+  const int num_pages = 200;
+  for (bool use_io_uring : {true, false}) {
+    AsyncDiskManager dm("test.db", DiskWriteMode::WRITE_BACK, DiskIOMode::BUFFERED, 16, use_io_uring);
+    if (!use_io_uring) {
+      EXPECT_EQ(AsyncIOBackend::THREAD_POOL, dm.GetBackend());
+    }
+
+    // Scenario: many more writes than the queue depth are in flight at once.
+    std::vector<std::vector<char>> data(num_pages, std::vector<char>(PAGE_SIZE));
+    std::vector<std::future<bool>> writes;
+    for (int i = 0; i < num_pages; i++) {
+      snprintf(data[i].data(), PAGE_SIZE, "page %d", i);
+      writes.push_back(dm.WritePageAsync(i, data[i].data()));
+    }
+    for (auto &write : writes) {
+      write.get();
+    }
+    EXPECT_EQ(num_pages, dm.GetNumWrites());
+    EXPECT_EQ(num_pages, dm.GetNumPages());
+    EXPECT_EQ(static_cast<size_t>(num_pages) * PAGE_SIZE, dm.GetDbFileSize());
+
+    // Scenario: asynchronous reads see the asynchronous writes.
+    std::vector<std::vector<char>> buf(num_pages, std::vector<char>(PAGE_SIZE));
+    std::vector<std::future<bool>> reads;
+    for (int i = 0; i < num_pages; i++) {
+      reads.push_back(dm.ReadPageAsync(i, buf[i].data()));
+    }
+    for (int i = 0; i < num_pages; i++) {
+      EXPECT_TRUE(reads[i].get());
+      EXPECT_EQ(0, std::memcmp(data[i].data(), buf[i].data(), PAGE_SIZE));
+    }
+
+    // Scenario: the synchronous API works alongside.
+    char page[PAGE_SIZE] = {0};
+    std::strncpy(page, "synchronous", sizeof(page));
+    dm.WritePage(3, page);
+    dm.ReadPageAsync(3, buf[3].data()).get();
+    EXPECT_EQ(0, std::memcmp(page, buf[3].data(), PAGE_SIZE));
+    dm.WritePageAsync(4, page).get();
+    dm.ReadPage(4, buf[4].data());
+    EXPECT_EQ(0, std::memcmp(page, buf[4].data(), PAGE_SIZE));
+
+    dm.ShutDown();
+    remove("test.db");
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(AsyncDiskManagerTest, ReadPagesTest) {
+  for (bool use_io_uring : {true, false}) {
+    AsyncDiskManager dm("test.db", DiskWriteMode::WRITE_BACK, DiskIOMode::BUFFERED, ASYNC_IO_QUEUE_DEPTH,
+                        use_io_uring);
+    char data[PAGE_SIZE] = {0};
+    for (int i = 0; i < 8; i++) {
+      snprintf(data, PAGE_SIZE, "page %d", i);
+      dm.WritePage(i, data);
+    }
+    // Allocated, but never written: reads as zeros.
+    dm.AllocatePage(9);
+
+    std::vector<page_id_t> page_ids{9, 6, 1, 4};
+    std::vector<std::vector<char>> buf(page_ids.size(), std::vector<char>(PAGE_SIZE, 'x'));
+    std::vector<char *> page_data;
+    for (auto &page : buf) {
+      page_data.push_back(page.data());
+    }
+    dm.ReadPages(page_ids, page_data);
+    EXPECT_EQ(std::vector<char>(PAGE_SIZE, 0), buf[0]);
+    for (size_t i = 1; i < page_ids.size(); i++) {
+      EXPECT_EQ("page " + std::to_string(page_ids[i]), std::string(buf[i].data()));
+    }
+
+    dm.ShutDown();
+    remove("test.db");
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(AsyncDiskManagerTest, DirectIOTest) {
+  for (bool use_io_uring : {true, false}) {
+    AsyncDiskManager dm("test.db", DiskWriteMode::WRITE_BACK, DiskIOMode::DIRECT, ASYNC_IO_QUEUE_DEPTH, use_io_uring);
+    // Scenario: aligned pages are transferred in place, unaligned ones through a copy.
+    auto *aligned = static_cast<char *>(std::aligned_alloc(PAGE_SIZE, 2 * PAGE_SIZE));
+    std::vector<char> unaligned_storage(2 * PAGE_SIZE + 1);
+    char *unaligned = unaligned_storage.data() + 1;
+    for (int i = 0; i < 2; i++) {
+      snprintf(aligned + i * PAGE_SIZE, PAGE_SIZE, "aligned %d", i);
+      snprintf(unaligned + i * PAGE_SIZE, PAGE_SIZE, "unaligned %d", i);
+    }
+    std::vector<std::future<bool>> writes;
+    writes.push_back(dm.WritePageAsync(0, aligned));
+    writes.push_back(dm.WritePageAsync(1, aligned + PAGE_SIZE));
+    writes.push_back(dm.WritePageAsync(2, unaligned));
+    writes.push_back(dm.WritePageAsync(3, unaligned + PAGE_SIZE));
+    for (auto &write : writes) {
+      write.get();
+    }
+
+    dm.ReadPages({2, 3, 0, 1}, {aligned, aligned + PAGE_SIZE, unaligned, unaligned + PAGE_SIZE});
+    EXPECT_EQ("unaligned 0", std::string(aligned));
+    EXPECT_EQ("unaligned 1", std::string(aligned + PAGE_SIZE));
+    EXPECT_EQ("aligned 0", std::string(unaligned));
+    EXPECT_EQ("aligned 1", std::string(unaligned + PAGE_SIZE));
+
+    free(aligned);
+    dm.ShutDown();
+    remove("test.db");
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(AsyncDiskManagerTest, BufferPoolTest) {
+  const size_t buffer_pool_size = 16;
+  auto *disk_manager = new AsyncDiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id;
+  for (int i = 0; i < 32; i++) {
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    bpm->UnpinPage(page_id, true);
+  }
+
+  // Scenario: a batched fetch and a prefetch read their misses through the asynchronous backend.
+  std::vector<page_id_t> page_ids{0, 2, 4, 6, 8, 10};
+  auto pages = bpm->FetchPages(page_ids);
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    ASSERT_NE(nullptr, pages[i]);
+    EXPECT_EQ("page " + std::to_string(page_ids[i]), std::string(pages[i]->GetData()));
+    bpm->UnpinPage(page_ids[i], false);
+  }
+  bpm->PrefetchPages({1, 3, 5, 7, 9});
+  for (page_id_t i = 1; i < 10; i += 2) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(i), std::string(page->GetData()));
+    bpm->UnpinPage(i, false);
+  }
+
+  delete bpm;
+  disk_manager->ShutDown();
+  delete disk_manager;
+}
+
+}  // namespace bustub
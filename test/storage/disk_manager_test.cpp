@@ -10,7 +10,17 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
 
 #include "common/exception.h"
 #include "gtest/gtest.h"
@@ -24,12 +34,14 @@ class DiskManagerTest : public ::testing::Test {
   void SetUp() override {
     remove("test.db");
     remove("test.log");
+    remove("test.fsm");
   }
 
   // This function is called after every test.
   void TearDown() override {
     remove("test.db");
     remove("test.log");
+    remove("test.fsm");
   };
 };
 
@@ -41,7 +53,7 @@ TEST_F(DiskManagerTest, ReadWritePageTest) {
   auto dm = DiskManager(db_file);
   std::strncpy(data, "A test string.", sizeof(data));
 
-  dm.ReadPage(0, buf);  // tolerate empty read
+  EXPECT_FALSE(dm.ReadPage(0, buf));  // tolerate empty read
 
   dm.WritePage(0, data);
   dm.ReadPage(0, buf);
@@ -55,6 +67,408 @@ TEST_F(DiskManagerTest, ReadWritePageTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, AllocatePageTest) {
+  char buf[PAGE_SIZE] = {0};
+  char data[PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+  std::strncpy(data, "A test string.", sizeof(data));
+
+  // Allocating pages only extends the logical extent of the file.
+  dm.AllocatePage(3);
+  EXPECT_EQ(4, dm.GetNumPages());
+  EXPECT_EQ(0, dm.GetNumWrites());
+
+  // Pages that were allocated but never written read as zeros, even past the end of the physical file.
+  dm.WritePage(1, data);
+  std::memset(buf, 1, sizeof(buf));
+  dm.ReadPage(3, buf);
+  EXPECT_EQ(std::count(buf, buf + PAGE_SIZE, 0), PAGE_SIZE);
+  std::memset(buf, 1, sizeof(buf));
+  dm.ReadPage(0, buf);
+  EXPECT_EQ(std::count(buf, buf + PAGE_SIZE, 0), PAGE_SIZE);
+  EXPECT_EQ(4, dm.GetNumPages());
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ConcurrentReadWritePageTest) {
+  const int num_threads = 8;
+  const int pages_per_thread = 64;
+  std::string db_file("test.db");
+  DiskManager dm(db_file);
+
+  // Scenario: every thread writes and reads back its own pages, interleaved with the other threads.
+  std::vector<std::thread> threads;
+  std::vector<int> num_mismatches(num_threads, 0);
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&dm, &num_mismatches, tid] {
+      char data[PAGE_SIZE];
+      char buf[PAGE_SIZE];
+      for (int round = 0; round < 4; ++round) {
+        for (int i = 0; i < pages_per_thread; ++i) {
+          page_id_t page_id = i * num_threads + tid;
+          std::memset(data, 0, sizeof(data));
+          snprintf(data, sizeof(data), "page %d round %d", page_id, round);
+          dm.WritePage(page_id, data);
+          dm.ReadPage(page_id, buf);
+          num_mismatches[tid] += std::memcmp(buf, data, sizeof(buf)) == 0 ? 0 : 1;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (int tid = 0; tid < num_threads; ++tid) {
+    EXPECT_EQ(0, num_mismatches[tid]);
+  }
+  EXPECT_EQ(num_threads * pages_per_thread * 4, dm.GetNumWrites());
+  EXPECT_EQ(static_cast<size_t>(num_threads * pages_per_thread * PAGE_SIZE), dm.GetDbFileSize());
+
+  // Scenario: a new disk manager picks the file size up from the file.
+  dm.ShutDown();
+  DiskManager reopened(db_file);
+  EXPECT_EQ(num_threads * pages_per_thread, reopened.GetNumPages());
+  char buf[PAGE_SIZE];
+  reopened.ReadPage(num_threads * pages_per_thread - 1, buf);
+  EXPECT_EQ("page " + std::to_string(num_threads * pages_per_thread - 1) + " round 3", std::string(buf));
+  reopened.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, WriteModeTest) {
+  char data[PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+
+  // Scenario: write-back only syncs when asked to.
+  DiskManager write_back(db_file);
+  EXPECT_EQ(DiskWriteMode::WRITE_BACK, write_back.GetWriteMode());
+  for (page_id_t page_id = 0; page_id < 4; ++page_id) {
+    write_back.WritePage(page_id, data);
+  }
+  EXPECT_EQ(0, write_back.GetNumSyncs());
+  write_back.Sync();
+  write_back.SyncLog();
+  EXPECT_EQ(2, write_back.GetNumSyncs());
+  write_back.ShutDown();
+
+  // Scenario: write-through syncs every page and every log flush.
+  DiskManager write_through(db_file, DiskWriteMode::WRITE_THROUGH);
+  for (page_id_t page_id = 0; page_id < 4; ++page_id) {
+    write_through.WritePage(page_id, data);
+  }
+  write_through.WriteLog(data, 16);
+  EXPECT_EQ(5, write_through.GetNumSyncs());
+  write_through.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, WritePagesTest) {
+  std::string db_file("test.db");
+  DiskManager dm(db_file, DiskWriteMode::WRITE_THROUGH);
+  std::vector<page_id_t> page_ids = {5, 1, 2, 3, 7, 6};
+  std::vector<std::string> contents;
+  std::vector<const char *> page_data;
+  for (page_id_t page_id : page_ids) {
+    contents.emplace_back(PAGE_SIZE, '\0');
+    snprintf(contents.back().data(), PAGE_SIZE, "page %d", page_id);
+  }
+  for (auto &content : contents) {
+    page_data.push_back(content.data());
+  }
+
+  // Scenario: the batch is written as two runs of consecutive pages and synced once.
+  dm.WritePages(page_ids, page_data);
+  EXPECT_EQ(page_ids.size(), dm.GetNumWrites());
+  EXPECT_EQ(2, dm.GetNumWriteCalls());
+  EXPECT_EQ(1, dm.GetNumSyncs());
+  EXPECT_EQ(8, dm.GetNumPages());
+
+  char buf[PAGE_SIZE];
+  for (page_id_t page_id : page_ids) {
+    dm.ReadPage(page_id, buf);
+    EXPECT_EQ("page " + std::to_string(page_id), std::string(buf));
+  }
+  dm.ReadPage(4, buf);
+  EXPECT_EQ(std::count(buf, buf + PAGE_SIZE, 0), PAGE_SIZE);
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, FreePageTest) {
+  char data[PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  {
+    DiskManager dm(db_file);
+    for (page_id_t page_id = 0; page_id < 10; ++page_id) {
+      dm.WritePage(page_id, data);
+    }
+
+    // Scenario: deallocated pages are claimed by the instance they mod back to, lowest page ids first.
+    dm.DeallocatePage(3);
+    dm.DeallocatePage(4);
+    dm.DeallocatePage(7);
+    dm.DeallocatePage(7);
+    dm.DeallocatePage(12);
+    EXPECT_EQ(3, dm.GetNumFreePages());
+    EXPECT_EQ(std::vector<page_id_t>({3}), dm.AllocateFreePages(2, 1, 1));
+    EXPECT_EQ(std::vector<page_id_t>({7}), dm.AllocateFreePages(2, 1, 16));
+    EXPECT_TRUE(dm.AllocateFreePages(2, 1, 16).empty());
+    EXPECT_EQ(std::vector<page_id_t>({4}), dm.AllocateFreePages(2, 0, 16));
+    EXPECT_EQ(0, dm.GetNumFreePages());
+
+    // Scenario: deallocations are persisted by Sync.
+    dm.DeallocatePage(5);
+    dm.DeallocatePage(6);
+    dm.Sync();
+    dm.ShutDown();
+  }
+  {
+    DiskManager dm(db_file);
+    EXPECT_EQ(2, dm.GetNumFreePages());
+    EXPECT_EQ(std::vector<page_id_t>({5}), dm.AllocateFreePages(1, 0, 1));
+    // Crash without syncing the deallocation.
+    dm.DeallocatePage(8);
+  }
+  {
+    // Scenario: claims are persisted right away, unsynced deallocations are lost.
+    DiskManager dm(db_file);
+    EXPECT_EQ(1, dm.GetNumFreePages());
+    EXPECT_EQ(std::vector<page_id_t>({6}), dm.AllocateFreePages(1, 0, 16));
+    dm.DeallocatePage(9);
+    dm.ShutDown();
+  }
+  remove("test.db");
+  {
+    // Scenario: the bitmap of a replaced database file has no pages to hand out.
+    DiskManager dm(db_file);
+    EXPECT_EQ(0, dm.GetNumFreePages());
+    EXPECT_TRUE(dm.AllocateFreePages(1, 0, 16).empty());
+    dm.ShutDown();
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DirectIOTest) {
+  std::string db_file("test.db");
+  DiskManager dm(db_file, DiskWriteMode::WRITE_BACK, DiskIOMode::DIRECT);
+
+  // Scenario: aligned buffers go straight to the device, unaligned ones are bounced.
+  auto *aligned = static_cast<char *>(std::aligned_alloc(PAGE_SIZE, PAGE_SIZE));
+  std::vector<char> unaligned_storage(PAGE_SIZE + 1);
+  char *unaligned = unaligned_storage.data() + 1;
+  std::memset(aligned, 0, PAGE_SIZE);
+  std::strncpy(aligned, "aligned", PAGE_SIZE);
+  std::memset(unaligned, 0, PAGE_SIZE);
+  std::strncpy(unaligned, "unaligned", PAGE_SIZE);
+  dm.WritePage(0, aligned);
+  dm.WritePage(1, unaligned);
+
+  std::memset(aligned, 0, PAGE_SIZE);
+  dm.ReadPage(1, aligned);
+  EXPECT_EQ("unaligned", std::string(aligned));
+  std::memset(unaligned, 0, PAGE_SIZE);
+  dm.ReadPage(0, unaligned);
+  EXPECT_EQ("aligned", std::string(unaligned));
+  dm.ShutDown();
+
+  // Scenario: the pages are in the file for a buffered reader as well.
+  DiskManager buffered(db_file);
+  EXPECT_EQ(DiskIOMode::BUFFERED, buffered.GetIOMode());
+  char buf[PAGE_SIZE];
+  buffered.ReadPage(0, buf);
+  EXPECT_EQ("aligned", std::string(buf));
+  buffered.ReadPage(1, buf);
+  EXPECT_EQ("unaligned", std::string(buf));
+  buffered.ShutDown();
+  free(aligned);
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ChecksumTest) {
+  char buf[PAGE_SIZE] = {0};
+  char data[PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  DiskManager dm(db_file);
+  dm.SetPageChecksums(true);
+
+  // Scenario: the checksum is stamped in the trailer of the written page, not in the caller's buffer.
+  std::strncpy(data, "A test string.", sizeof(data));
+  dm.WritePage(0, data);
+  dm.WritePages({1, 2}, {data, data});
+  EXPECT_EQ(0, data[PAGE_CONTENT_SIZE]);
+  for (page_id_t page_id = 0; page_id < 3; page_id++) {
+    EXPECT_TRUE(dm.ReadPage(page_id, buf));
+    EXPECT_EQ(std::memcmp(buf, data, PAGE_CONTENT_SIZE), 0);
+    uint32_t stored;
+    std::memcpy(&stored, buf + PAGE_CONTENT_SIZE, sizeof(stored));
+    EXPECT_EQ(DiskManager::ComputePageChecksum(page_id, data), stored);
+  }
+  EXPECT_EQ(0, dm.GetNumChecksumFailures());
+
+  // Scenario: a hole in the file reads as a zeroed page, which verifies.
+  dm.WritePage(4, data);
+  EXPECT_TRUE(dm.ReadPage(3, buf));
+  EXPECT_EQ(0, dm.GetNumChecksumFailures());
+
+  // Scenario: a flipped byte and a page written to the wrong place are both detected and fail the read.
+  std::fstream file(db_file, std::ios::binary | std::ios::in | std::ios::out);
+  file.seekp(PAGE_SIZE + 7);
+  file.put('X');
+  EXPECT_TRUE(dm.ReadPage(0, buf));
+  file.seekp(2 * PAGE_SIZE);
+  file.write(buf, PAGE_SIZE);
+  file.close();
+  EXPECT_FALSE(dm.ReadPage(1, buf));
+  EXPECT_EQ(1, dm.GetNumChecksumFailures());
+  EXPECT_FALSE(dm.ReadPage(2, buf));
+  EXPECT_EQ(2, dm.GetNumChecksumFailures());
+  EXPECT_EQ(std::vector<bool>({true, false, false}), dm.ReadPages({0, 1, 2}, {buf, buf, buf}));
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, StripeTest) {
+  const std::vector<std::string> stripe_dirs{"test_stripe_1", "test_stripe_2"};
+  const std::vector<std::string> stripe_files{"test_stripe_1/test.1.db", "test_stripe_2/test.2.db"};
+  for (const auto &dir : stripe_dirs) {
+    mkdir(dir.c_str(), 0755);
+  }
+  std::string db_file("test.db");
+  const auto num_pages = static_cast<page_id_t>(4 * STRIPE_NUM_PAGES + 5);
+  char buf[PAGE_SIZE] = {0};
+  char data[PAGE_SIZE] = {0};
+  {
+    DiskManager dm(db_file, DiskWriteMode::WRITE_BACK, DiskIOMode::BUFFERED, stripe_dirs);
+    EXPECT_EQ(3, dm.GetNumDataFiles());
+
+    // Scenario: stripes of pages are dealt out to the files round-robin.
+    EXPECT_EQ(db_file, dm.GetDataFileName(0));
+    EXPECT_EQ(db_file, dm.GetDataFileName(STRIPE_NUM_PAGES - 1));
+    EXPECT_EQ(stripe_files[0], dm.GetDataFileName(STRIPE_NUM_PAGES));
+    EXPECT_EQ(stripe_files[1], dm.GetDataFileName(2 * STRIPE_NUM_PAGES));
+    EXPECT_EQ(db_file, dm.GetDataFileName(3 * STRIPE_NUM_PAGES));
+
+    // Scenario: single and batched writes land in the right file.
+    std::vector<page_id_t> page_ids;
+    std::vector<const char *> page_data;
+    std::vector<std::vector<char>> pages;
+    for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+      pages.emplace_back(PAGE_SIZE, 0);
+      snprintf(pages.back().data(), PAGE_SIZE, "page %d", page_id);
+    }
+    for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+      if (page_id % 2 == 0) {
+        dm.WritePage(page_id, pages[page_id].data());
+      } else {
+        page_ids.push_back(page_id);
+        page_data.push_back(pages[page_id].data());
+      }
+    }
+    dm.WritePages(page_ids, page_data);
+    EXPECT_EQ(static_cast<size_t>(num_pages) * PAGE_SIZE, dm.GetDbFileSize());
+    for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+      dm.ReadPage(page_id, buf);
+      EXPECT_EQ(0, std::memcmp(buf, pages[page_id].data(), PAGE_SIZE));
+    }
+    dm.ShutDown();
+  }
+
+  struct stat stat_buf;
+  stat(db_file.c_str(), &stat_buf);
+  EXPECT_EQ(2 * STRIPE_NUM_PAGES * PAGE_SIZE, stat_buf.st_size);
+  stat(stripe_files[0].c_str(), &stat_buf);
+  EXPECT_EQ((STRIPE_NUM_PAGES + 5) * PAGE_SIZE, stat_buf.st_size);
+
+  // Scenario: the logical extent and the pages are recovered from all files on reopen.
+  DiskManager dm(db_file, DiskWriteMode::WRITE_BACK, DiskIOMode::BUFFERED, stripe_dirs);
+  EXPECT_EQ(num_pages, dm.GetNumPages());
+  dm.ReadPage(2 * STRIPE_NUM_PAGES + 3, buf);
+  snprintf(data, PAGE_SIZE, "page %d", static_cast<int>(2 * STRIPE_NUM_PAGES + 3));
+  EXPECT_EQ(0, std::memcmp(buf, data, PAGE_SIZE));
+  dm.ShutDown();
+
+  for (size_t i = 0; i < stripe_dirs.size(); i++) {
+    remove(stripe_files[i].c_str());
+    remove(stripe_dirs[i].c_str());
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, PreallocationTest) {
+  char data[PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  const page_id_t num_pages = 700;
+  {
+    DiskManager dm(db_file);
+    std::strncpy(data, "A test string.", sizeof(data));
+    for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+      dm.AllocatePage(page_id);
+      dm.WritePage(page_id, data);
+    }
+    struct stat stat_buf;
+    stat(db_file.c_str(), &stat_buf);
+    EXPECT_EQ(static_cast<size_t>(num_pages) * PAGE_SIZE, stat_buf.st_size);
+    // Scenario: extents of 1, 2 and 4 MB are reserved as the pages reach the last quarter of the previous one. The
+    // file system may not support preallocation, in which case the file grows page by page.
+    if (dm.GetNumPreallocations() > 0) {
+      EXPECT_EQ(3, dm.GetNumPreallocations());
+      EXPECT_GE(static_cast<size_t>(stat_buf.st_blocks) * 512, 7 * PREALLOCATE_MIN_SIZE);
+    }
+    dm.ShutDown();
+  }
+
+  // Scenario: the preallocated space is not mistaken for pages on reopen.
+  DiskManager dm(db_file);
+  EXPECT_EQ(num_pages, dm.GetNumPages());
+  char buf[PAGE_SIZE] = {0};
+  dm.ReadPage(num_pages - 1, buf);
+  EXPECT_EQ(0, std::memcmp(buf, data, PAGE_SIZE));
+  dm.ShutDown();
+  remove(db_file.c_str());
+
+  DiskManager no_preallocation(db_file);
+  no_preallocation.SetPreallocation(false);
+  no_preallocation.WritePage(0, data);
+  EXPECT_EQ(0, no_preallocation.GetNumPreallocations());
+  no_preallocation.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DISABLED_PreallocationBenchmark) {
+  const page_id_t num_pages = 64 * 1024;
+  char data[PAGE_SIZE] = {0};
+  std::strncpy(data, "A test string.", sizeof(data));
+
+  // Bulk load: append pages one by one, syncing every 256 pages like a checkpointing loader would.
+  for (bool preallocate : {false, true}) {
+    remove("test.db");
+    DiskManager dm("test.db");
+    dm.SetPreallocation(preallocate);
+    std::chrono::duration<double> max_latency{0};
+    int num_stalls = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+      auto write_start = std::chrono::steady_clock::now();
+      dm.AllocatePage(page_id);
+      dm.WritePage(page_id, data);
+      if (page_id % 256 == 255) {
+        dm.Sync();
+      }
+      std::chrono::duration<double> latency = std::chrono::steady_clock::now() - write_start;
+      max_latency = std::max(max_latency, latency);
+      num_stalls += latency > std::chrono::milliseconds(1) ? 1 : 0;
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    printf("preallocation %s: %.2f s, %d extents, %d writes over 1 ms, max %.3f ms\n", preallocate ? "on" : "off",
+           elapsed.count(), dm.GetNumPreallocations(), num_stalls, max_latency.count() * 1000);
+    dm.ShutDown();
+  }
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ReadWriteLogTest) {
   char buf[16] = {0};
@@ -72,6 +486,62 @@ TEST_F(DiskManagerTest, ReadWriteLogTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, IOStatsTest) {
+  char buf[PAGE_SIZE] = {0};
+  char data[PAGE_SIZE] = {0};
+  char log[16] = {0};
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+  std::strncpy(data, "A test string.", sizeof(data));
+
+  // Scenario: every operation is counted under the category of the scope that issued it, OTHER outside of any.
+  for (int i = 0; i < 3; i++) {
+    IOCategoryScope scope(IOCategory::EVICTION);
+    dm.WritePage(i, data);
+  }
+  {
+    IOCategoryScope scope(IOCategory::CHECKPOINT);
+    dm.WritePage(3, data);
+    {
+      IOCategoryScope inner(IOCategory::BUFFER_MISS);
+      dm.ReadPage(0, buf);
+      dm.ReadPage(1, buf);
+    }
+    dm.Sync();
+  }
+  dm.ReadPage(2, buf);
+  EXPECT_EQ(IOCategory::OTHER, IOCategoryScope::Current());
+
+  // Scenario: the log is always WAL, whatever the scope.
+  dm.WriteLog(log, sizeof(log));
+  dm.SyncLog();
+
+  auto stats = dm.GetIOStats();
+  EXPECT_EQ(3, stats.Get(IOOperation::WRITE_PAGE, IOCategory::EVICTION).count_);
+  EXPECT_EQ(1, stats.Get(IOOperation::WRITE_PAGE, IOCategory::CHECKPOINT).count_);
+  EXPECT_EQ(4, stats.Get(IOOperation::WRITE_PAGE).count_);
+  EXPECT_EQ(2, stats.Get(IOOperation::READ_PAGE, IOCategory::BUFFER_MISS).count_);
+  EXPECT_EQ(1, stats.Get(IOOperation::READ_PAGE, IOCategory::OTHER).count_);
+  EXPECT_EQ(1, stats.Get(IOOperation::SYNC, IOCategory::CHECKPOINT).count_);
+  EXPECT_EQ(1, stats.Get(IOOperation::SYNC, IOCategory::WAL).count_);
+  EXPECT_EQ(1, stats.Get(IOOperation::WRITE_LOG, IOCategory::WAL).count_);
+  EXPECT_EQ(0, stats.Get(IOOperation::WRITE_LOG, IOCategory::OTHER).count_);
+  const auto &writes = stats.Get(IOOperation::WRITE_PAGE, IOCategory::EVICTION);
+  EXPECT_GT(writes.max_ns_, 0);
+  EXPECT_LE(writes.Percentile(50), writes.max_ns_);
+  EXPECT_NE(std::string::npos, stats.ToString().find("write_page/eviction: count=3"));
+
+  // Scenario: reset forgets everything.
+  dm.ResetIOStats();
+  stats = dm.GetIOStats();
+  EXPECT_EQ(0, stats.Get(IOOperation::WRITE_PAGE).count_);
+  EXPECT_EQ(0, stats.Get(IOOperation::SYNC).count_);
+  EXPECT_EQ("", stats.ToString());
+
+  dm.ShutDown();
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ThrowBadFileTest) { EXPECT_THROW(DiskManager("dev/null\\/foo/bar/baz/test.db"), Exception); }
 
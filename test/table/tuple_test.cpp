@@ -11,7 +11,9 @@
 //===----------------------------------------------------------------------===//
 
 #include <algorithm>
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <cstring>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -71,4 +73,136 @@ TEST(TupleTest, DISABLED_TableHeapTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(TupleTest, MappedScanTest) {
+  Column col1{"a", TypeId::VARCHAR, 20};
+  Column col2{"b", TypeId::SMALLINT};
+  Column col3{"c", TypeId::BIGINT};
+  std::vector<Column> cols{col1, col2, col3};
+  Schema schema{cols};
+  Tuple tuple = ConstructTuple(&schema);
+
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *buffer_pool_manager = new BufferPoolManagerInstance(50, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *log_manager = new LogManager(disk_manager);
+  auto *table = new TableHeap(buffer_pool_manager, lock_manager, log_manager, transaction);
+  std::vector<RID> rid_v;
+  for (int i = 0; i < 10000; ++i) {
+    RID rid;
+    table->InsertTuple(tuple, &rid, transaction);
+    rid_v.push_back(rid);
+  }
+
+  // Scenario: a mapped scan reads every tuple without touching the buffer pool.
+  ASSERT_TRUE(buffer_pool_manager->SetMappedReads(true));
+  EXPECT_NE(nullptr, buffer_pool_manager->GetMappedPage(rid_v[0].GetPageId()));
+  buffer_pool_manager->ResetStats();
+  size_t num_tuples = 0;
+  for (auto itr = table->Begin(transaction); itr != table->End(); ++itr) {
+    ASSERT_LT(num_tuples, rid_v.size());
+    EXPECT_EQ(rid_v[num_tuples], itr->GetRid());
+    EXPECT_EQ(tuple.GetLength(), itr->GetLength());
+    EXPECT_EQ(0, std::memcmp(tuple.GetData(), itr->GetData(), tuple.GetLength()));
+    num_tuples++;
+  }
+  EXPECT_EQ(rid_v.size(), num_tuples);
+  BufferPoolStats stats = buffer_pool_manager->GetStats();
+  EXPECT_EQ(0, stats.num_hits_ + stats.num_misses_);
+  EXPECT_LE(static_cast<size_t>(disk_manager->GetNumPages()), disk_manager->GetNumAdvisedPages());
+
+  // Scenario: a scan only advises a window of pages ahead of itself, starting with the page after the first one.
+  ASSERT_LT(MAPPED_SCAN_WINDOW_PAGES + 1, static_cast<size_t>(disk_manager->GetNumPages()));
+  size_t num_advised_pages = disk_manager->GetNumAdvisedPages();
+  {
+    auto itr = table->Begin(transaction);
+    EXPECT_EQ(num_advised_pages, disk_manager->GetNumAdvisedPages());
+    ++itr;
+    EXPECT_EQ(MAPPED_SCAN_WINDOW_PAGES + 1, disk_manager->GetNumAdvisedPages() - num_advised_pages);
+    // Scenario: an iterator dropped halfway resets the advice of its window.
+    num_advised_pages = disk_manager->GetNumAdvisedPages();
+  }
+  EXPECT_EQ(MAPPED_SCAN_WINDOW_PAGES, disk_manager->GetNumAdvisedPages() - num_advised_pages);
+
+  // Scenario: a heap whose first page is not page 0 is scanned from the mapping as well.
+  ASSERT_TRUE(buffer_pool_manager->SetMappedReads(false));
+  auto *other_table = new TableHeap(buffer_pool_manager, lock_manager, log_manager, transaction);
+  RID other_rid;
+  for (int i = 0; i < 300; ++i) {
+    other_table->InsertTuple(tuple, &other_rid, transaction);
+  }
+  ASSERT_TRUE(buffer_pool_manager->SetMappedReads(true));
+  ASSERT_NE(0, other_table->GetFirstPageId());
+  buffer_pool_manager->ResetStats();
+  num_tuples = 0;
+  for (auto other_itr = other_table->Begin(transaction); other_itr != other_table->End(); ++other_itr) {
+    num_tuples++;
+  }
+  EXPECT_EQ(300, num_tuples);
+  stats = buffer_pool_manager->GetStats();
+  EXPECT_EQ(0, stats.num_hits_ + stats.num_misses_);
+  delete other_table;
+
+  // Scenario: with mapped reads off, the scan goes through the buffer pool again.
+  buffer_pool_manager->SetMappedReads(false);
+  EXPECT_EQ(nullptr, buffer_pool_manager->GetMappedPage(rid_v[0].GetPageId()));
+  num_tuples = 0;
+  for (auto itr = table->Begin(transaction); itr != table->End(); ++itr) {
+    num_tuples++;
+  }
+  EXPECT_EQ(rid_v.size(), num_tuples);
+  EXPECT_GT(buffer_pool_manager->GetStats().num_hits_ + buffer_pool_manager->GetStats().num_misses_, 0);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.log");
+  delete table;
+  delete buffer_pool_manager;
+  delete log_manager;
+  delete lock_manager;
+  delete disk_manager;
+  delete transaction;
+}
+
+// NOLINTNEXTLINE
+TEST(TupleTest, DISABLED_BulkInsertBenchmark) {
+  Column col1{"a", TypeId::VARCHAR, 20};
+  Column col2{"b", TypeId::SMALLINT};
+  Column col3{"c", TypeId::BIGINT};
+  Column col4{"d", TypeId::BOOLEAN};
+  Column col5{"e", TypeId::VARCHAR, 16};
+  std::vector<Column> cols{col1, col2, col3, col4, col5};
+  Schema schema{cols};
+  Tuple tuple = ConstructTuple(&schema);
+  const int num_tuples = 20000;
+
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *buffer_pool_manager = new BufferPoolManagerInstance(400, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *log_manager = new LogManager(disk_manager);
+  auto *table = new TableHeap(buffer_pool_manager, lock_manager, log_manager, transaction);
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_tuples; ++i) {
+    RID rid;
+    table->InsertTuple(tuple, &rid, transaction);
+  }
+  buffer_pool_manager->FlushAllPages();
+  auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+  std::cout << num_tuples << " inserts in " << elapsed.count() << " ms, " << disk_manager->GetNumWrites()
+            << " page writes for " << disk_manager->GetNumPages() << " pages" << std::endl;
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.log");
+  delete table;
+  delete buffer_pool_manager;
+  delete log_manager;
+  delete lock_manager;
+  delete disk_manager;
+  delete transaction;
+}
+
 }  // namespace bustub